@@ -0,0 +1,81 @@
+/*
+ * Times WriteE4B for banks of increasing size, up to EOS_E4_MAX_PRESETS presets and EOS_E4_MAX_SAMPLES samples.
+ * Writing is linear when the time per chunk stays flat as the bank grows.
+ */
+#include "simple_e4b.hpp"
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+	constexpr size_t NUM_VOICES_PER_PRESET = 4;
+	constexpr size_t NUM_ZONES_PER_VOICE = 4;
+	constexpr size_t NUM_SAMPLE_FRAMES = 1024;
+	constexpr uint32_t NUM_REPEATS = 5u;
+
+	simple_e4b::E4BBank CreateBank(const size_t numPresets, const size_t numSamples)
+	{
+		simple_e4b::E4BBank bank;
+
+		for(size_t sampleIndex(0); sampleIndex < numSamples; ++sampleIndex)
+		{
+			std::vector<int16_t> sampleData(NUM_SAMPLE_FRAMES);
+			for(size_t i(0); i < sampleData.size(); ++i) { sampleData[i] = static_cast<int16_t>(i * 31u + sampleIndex); }
+
+			bank.AddSample(simple_e4b::E3Sample("Sample " + std::to_string(sampleIndex), std::move(sampleData), 44100u, 1u,
+				simple_e4b::SampleLoopInfo(), static_cast<uint16_t>(sampleIndex)));
+		}
+
+		for(size_t presetIndex(0); presetIndex < numPresets; ++presetIndex)
+		{
+			std::vector<simple_e4b::E4Voice> voices(NUM_VOICES_PER_PRESET);
+			for(auto& voice : voices)
+			{
+				for(size_t zone(0); zone < NUM_ZONES_PER_VOICE; ++zone)
+				{
+					const uint16_t sampleIndex(static_cast<uint16_t>((presetIndex + zone) % std::max(numSamples, size_t(1))));
+					voice.AddSampleZone(simple_e4b::E4SampleZone(sampleIndex, simple_e4b::MidiNote(static_cast<uint8_t>(48u + zone * 12u))));
+				}
+			}
+
+			bank.AddPreset(simple_e4b::E4Preset("Preset " + std::to_string(presetIndex), std::move(voices), static_cast<uint16_t>(presetIndex)));
+		}
+
+		return bank;
+	}
+}
+
+int main()
+{
+	const std::filesystem::path benchFile(std::filesystem::temp_directory_path() / "simple_e4b_write_scaling.E4B");
+
+	std::printf("%8s %8s %12s %16s\n", "presets", "samples", "best ms", "us per chunk");
+
+	// Doubles up to the limits, each bank having as many presets as samples:
+	const size_t maxCount(std::min(simple_e4b::EOS_E4_MAX_PRESETS, simple_e4b::EOS_E4_MAX_SAMPLES));
+	for(size_t halvings(5); halvings-- > 0;)
+	{
+		const size_t count(maxCount >> halvings);
+		const simple_e4b::E4BBank bank(CreateBank(count, count));
+
+		// The fastest of a few writes, as the least disturbed by the rest of the system:
+		double bestSeconds(std::numeric_limits<double>::max());
+		for(uint32_t repeat(0u); repeat < NUM_REPEATS; ++repeat)
+		{
+			const auto start(std::chrono::steady_clock::now());
+			if(!simple_e4b::WriteE4B(benchFile, bank))
+			{
+				std::printf("Failed to write %s\n", benchFile.string().c_str());
+				return 1;
+			}
+
+			bestSeconds = std::min(bestSeconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		std::printf("%8zu %8zu %12.3f %16.3f\n", count, count, bestSeconds * 1000., bestSeconds * 1000000. / static_cast<double>(count * 2u));
+	}
+
+	std::error_code error;
+	std::filesystem::remove(benchFile, error);
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,859 @@
+#pragma once
+#include "e4b_types.hpp"
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <numeric>
+#include <thread>
+
+// SIMD paths are picked at compile time from the target's instruction sets, define SIMPLE_E4B_NO_SIMD to only use the scalar code:
+#ifndef SIMPLE_E4B_NO_SIMD
+#if defined(__AVX2__)
+#define SIMPLE_E4B_AVX2
+#endif
+#if defined(SIMPLE_E4B_AVX2) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMPLE_E4B_SSE2
+#include <immintrin.h>
+#endif
+#endif
+
+namespace simple_e4b
+{
+	constexpr float PCM_TO_FLOAT_SCALE = 1.f / 32768.f;
+	constexpr float FLOAT_TO_PCM_SCALE = 32768.f;
+
+	/**
+	 * \brief Triangular (TPDF) dither of +-1 LSB, from xorshift generators which are kept between calls so consecutive blocks don't repeat the same noise.
+	 */
+	struct E4Dither final
+	{
+		explicit E4Dither(const uint32_t seed = 0x9E37'79B9u)
+		{
+			uint32_t state(seed);
+			for(auto& lane : m_lanes)
+			{
+				state = state * 1'664'525u + 1'013'904'223u;
+				lane = state != 0u ? state : 1u; // Xorshift never leaves 0
+			}
+		}
+
+		/**
+		 * \return (-1, 1)
+		 */
+		[[nodiscard]] float Next()
+		{
+			const float first(ToUnitFloat(NextLane(m_lanes[0])));
+			return first - ToUnitFloat(NextLane(m_lanes[0]));
+		}
+
+#ifdef SIMPLE_E4B_SSE2
+		[[nodiscard]] __m128 Next4()
+		{
+			__m128i lanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(m_lanes.data())));
+			lanes = NextLanes(lanes);
+			const __m128 first(ToUnitFloats(lanes));
+			lanes = NextLanes(lanes);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(m_lanes.data()), lanes);
+			return _mm_sub_ps(first, ToUnitFloats(lanes));
+		}
+#endif
+
+#ifdef SIMPLE_E4B_AVX2
+		[[nodiscard]] __m256 Next8()
+		{
+			__m256i lanes(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_lanes.data())));
+			lanes = NextLanes(lanes);
+			const __m256 first(ToUnitFloats(lanes));
+			lanes = NextLanes(lanes);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(m_lanes.data()), lanes);
+			return _mm256_sub_ps(first, ToUnitFloats(lanes));
+		}
+#endif
+
+	private:
+		static constexpr uint32_t FLOAT_ONE_BITS = 0x3F80'0000u;
+
+		[[nodiscard]] static uint32_t NextLane(uint32_t& lane)
+		{
+			lane ^= lane << 13;
+			lane ^= lane >> 17;
+			lane ^= lane << 5;
+			return lane;
+		}
+
+		// The top 23 bits become the mantissa of a float in [1, 2):
+		[[nodiscard]] static float ToUnitFloat(const uint32_t value)
+		{
+			const uint32_t bits((value >> 9) | FLOAT_ONE_BITS);
+			float result;
+			std::memcpy(&result, &bits, sizeof(float));
+			return result - 1.f;
+		}
+
+#ifdef SIMPLE_E4B_SSE2
+		[[nodiscard]] static __m128i NextLanes(__m128i lanes)
+		{
+			lanes = _mm_xor_si128(lanes, _mm_slli_epi32(lanes, 13));
+			lanes = _mm_xor_si128(lanes, _mm_srli_epi32(lanes, 17));
+			return _mm_xor_si128(lanes, _mm_slli_epi32(lanes, 5));
+		}
+
+		[[nodiscard]] static __m128 ToUnitFloats(const __m128i lanes)
+		{
+			const __m128i bits(_mm_or_si128(_mm_srli_epi32(lanes, 9), _mm_set1_epi32(static_cast<int>(FLOAT_ONE_BITS))));
+			return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.f));
+		}
+#endif
+
+#ifdef SIMPLE_E4B_AVX2
+		[[nodiscard]] static __m256i NextLanes(__m256i lanes)
+		{
+			lanes = _mm256_xor_si256(lanes, _mm256_slli_epi32(lanes, 13));
+			lanes = _mm256_xor_si256(lanes, _mm256_srli_epi32(lanes, 17));
+			return _mm256_xor_si256(lanes, _mm256_slli_epi32(lanes, 5));
+		}
+
+		[[nodiscard]] static __m256 ToUnitFloats(const __m256i lanes)
+		{
+			const __m256i bits(_mm256_or_si256(_mm256_srli_epi32(lanes, 9), _mm256_set1_epi32(static_cast<int>(FLOAT_ONE_BITS))));
+			return _mm256_sub_ps(_mm256_castsi256_ps(bits), _mm256_set1_ps(1.f));
+		}
+#endif
+
+		std::array<uint32_t, 8> m_lanes{};
+	};
+
+	/**
+	 * \brief Converts int16 PCM to float, multiplying by scale ([-1, 1) by default).
+	 */
+	inline void ConvertToFloat(const Span<const int16_t> input, const Span<float> output, const float scale = PCM_TO_FLOAT_SCALE)
+	{
+		assert(output.size() >= input.size());
+		if(output.size() < input.size()) { return; }
+
+		const int16_t* in(input.data());
+		float* out(output.data());
+
+		size_t i(0);
+#ifdef SIMPLE_E4B_AVX2
+		const __m256 scale8(_mm256_set1_ps(scale));
+		for(; i + 16 <= input.size(); i += 16)
+		{
+			const __m256i low(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+			const __m256i high(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8))));
+			_mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(low), scale8));
+			_mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(high), scale8));
+		}
+#endif
+#ifdef SIMPLE_E4B_SSE2
+		const __m128 scale4(_mm_set1_ps(scale));
+		for(; i + 8 <= input.size(); i += 8)
+		{
+			// Sign extend each int16 by placing it in the top half of an int32 and shifting it back down:
+			const __m128i values(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+			const __m128i low(_mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16));
+			const __m128i high(_mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16));
+			_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale4));
+			_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale4));
+		}
+#endif
+		for(; i < input.size(); ++i)
+		{
+			out[i] = static_cast<float>(in[i]) * scale;
+		}
+	}
+
+	/**
+	 * \brief Converts float to int16 PCM, multiplying by scale, optionally dithering, then rounding to nearest and clamping.
+	 */
+	inline void ConvertToInt16(const Span<const float> input, const Span<int16_t> output, const float scale = FLOAT_TO_PCM_SCALE, E4Dither* dither = nullptr)
+	{
+		assert(output.size() >= input.size());
+		if(output.size() < input.size()) { return; }
+
+		constexpr float PCM_MIN(static_cast<float>(std::numeric_limits<int16_t>::min()));
+		constexpr float PCM_MAX(static_cast<float>(std::numeric_limits<int16_t>::max()));
+
+		const float* in(input.data());
+		int16_t* out(output.data());
+
+		size_t i(0);
+#ifdef SIMPLE_E4B_AVX2
+		const __m256 scale8(_mm256_set1_ps(scale));
+		const __m256 min8(_mm256_set1_ps(PCM_MIN));
+		const __m256 max8(_mm256_set1_ps(PCM_MAX));
+		for(; i + 16 <= input.size(); i += 16)
+		{
+			__m256 low(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale8));
+			__m256 high(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale8));
+			if(dither != nullptr)
+			{
+				low = _mm256_add_ps(low, dither->Next8());
+				high = _mm256_add_ps(high, dither->Next8());
+			}
+
+			const __m256i lowInts(_mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(low, min8), max8)));
+			const __m256i highInts(_mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(high, min8), max8)));
+
+			// Packing works within each 128-bit half, so the middle 64-bit blocks have to be swapped back into order:
+			const __m256i packed(_mm256_permute4x64_epi64(_mm256_packs_epi32(lowInts, highInts), 0xD8));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+		}
+#endif
+#ifdef SIMPLE_E4B_SSE2
+		const __m128 scale4(_mm_set1_ps(scale));
+		const __m128 min4(_mm_set1_ps(PCM_MIN));
+		const __m128 max4(_mm_set1_ps(PCM_MAX));
+		for(; i + 8 <= input.size(); i += 8)
+		{
+			__m128 low(_mm_mul_ps(_mm_loadu_ps(in + i), scale4));
+			__m128 high(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale4));
+			if(dither != nullptr)
+			{
+				low = _mm_add_ps(low, dither->Next4());
+				high = _mm_add_ps(high, dither->Next4());
+			}
+
+			const __m128i lowInts(_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(low, min4), max4)));
+			const __m128i highInts(_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(high, min4), max4)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(lowInts, highInts));
+		}
+#endif
+		for(; i < input.size(); ++i)
+		{
+			float value(in[i] * scale);
+			if(dither != nullptr) { value += dither->Next(); }
+
+			// lrint rounds the same way as the SIMD conversions (to nearest even under the default rounding mode):
+			out[i] = static_cast<int16_t>(std::lrint(std::clamp(value, PCM_MIN, PCM_MAX)));
+		}
+	}
+
+	/**
+	 * \brief Splits interleaved stereo frames (L R L R ...) into separate left and right channels.
+	 */
+	inline void SplitStereo(const Span<const int16_t> interleaved, const Span<int16_t> left, const Span<int16_t> right)
+	{
+		const size_t numFrames(interleaved.size() / 2);
+		assert(left.size() >= numFrames && right.size() >= numFrames);
+		if(left.size() < numFrames || right.size() < numFrames) { return; }
+
+		const int16_t* in(interleaved.data());
+
+		size_t i(0);
+#ifdef SIMPLE_E4B_SSE2
+		for(; i + 8 <= numFrames; i += 8)
+		{
+			const __m128i first(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2)));
+			const __m128i second(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2 + 8)));
+
+			// Each frame is an int32 with left in the bottom half, sign extending either half keeps packing from saturating:
+			const __m128i leftValues(_mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(first, 16), 16), _mm_srai_epi32(_mm_slli_epi32(second, 16), 16)));
+			const __m128i rightValues(_mm_packs_epi32(_mm_srai_epi32(first, 16), _mm_srai_epi32(second, 16)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(left.data() + i), leftValues);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(right.data() + i), rightValues);
+		}
+#endif
+		for(; i < numFrames; ++i)
+		{
+			left[i] = in[i * 2];
+			right[i] = in[i * 2 + 1];
+		}
+	}
+
+	/**
+	 * \brief Merges separate left and right channels into interleaved stereo frames (L R L R ...).
+	 */
+	inline void MergeStereo(const Span<const int16_t> left, const Span<const int16_t> right, const Span<int16_t> interleaved)
+	{
+		const size_t numFrames(std::min(left.size(), right.size()));
+		assert(interleaved.size() >= numFrames * 2);
+		if(interleaved.size() < numFrames * 2) { return; }
+
+		int16_t* out(interleaved.data());
+
+		size_t i(0);
+#ifdef SIMPLE_E4B_SSE2
+		for(; i + 8 <= numFrames; i += 8)
+		{
+			const __m128i leftValues(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left.data() + i)));
+			const __m128i rightValues(_mm_loadu_si128(reinterpret_cast<const __m128i*>(right.data() + i)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi16(leftValues, rightValues));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 8), _mm_unpackhi_epi16(leftValues, rightValues));
+		}
+#endif
+		for(; i < numFrames; ++i)
+		{
+			out[i * 2] = left[i];
+			out[i * 2 + 1] = right[i];
+		}
+	}
+
+	/**
+	 * \brief Swaps the byte order of every value, such as for big endian (AIFF) audio.
+	 */
+	inline void ByteswapInt16(const Span<int16_t> data)
+	{
+		int16_t* values(data.data());
+
+		size_t i(0);
+#ifdef SIMPLE_E4B_AVX2
+		for(; i + 16 <= data.size(); i += 16)
+		{
+			const __m256i loaded(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_or_si256(_mm256_slli_epi16(loaded, 8), _mm256_srli_epi16(loaded, 8)));
+		}
+#endif
+#ifdef SIMPLE_E4B_SSE2
+		for(; i + 8 <= data.size(); i += 8)
+		{
+			const __m128i loaded(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_or_si128(_mm_slli_epi16(loaded, 8), _mm_srli_epi16(loaded, 8)));
+		}
+#endif
+		for(; i < data.size(); ++i)
+		{
+			values[i] = static_cast<int16_t>(byteswap_helpers::byteswap_uint16(static_cast<uint16_t>(values[i])));
+		}
+	}
+
+	/**
+	 * \return One channel of the sample converted to float, mono samples return the same data for either channel
+	 */
+	[[nodiscard]] inline std::vector<float> GetChannelDataFloat(const E3Sample& sample, const ESampleType type, const float scale = PCM_TO_FLOAT_SCALE)
+	{
+		const Span<const int16_t> channelData(sample.GetChannelData(type));
+
+		std::vector<float> result(channelData.size());
+		ConvertToFloat(channelData, result, scale);
+		return result;
+	}
+
+	/**
+	 * \return The sample's left and right regions merged into interleaved frames, mono samples are returned as is
+	 */
+	[[nodiscard]] inline std::vector<int16_t> GetInterleavedData(const E3Sample& sample)
+	{
+		const Span<const int16_t> left(sample.GetChannelData(ESampleType::LEFT));
+		if(sample.GetNumChannels() != 2u)
+		{
+			return std::vector<int16_t>{left.begin(), left.end()};
+		}
+
+		const Span<const int16_t> right(sample.GetChannelData(ESampleType::RIGHT));
+
+		std::vector<int16_t> result(std::min(left.size(), right.size()) * 2);
+		MergeStereo(left, right, result);
+		return result;
+	}
+
+	/**
+	 * \brief Splits interleaved frames into the left then right regions E3Sample stores, ready to be moved into its constructor.
+	 */
+	[[nodiscard]] inline std::vector<int16_t> MakeSampleData(const Span<const int16_t> interleaved, const uint32_t numChannels)
+	{
+		if(numChannels != 2u)
+		{
+			return std::vector<int16_t>{interleaved.begin(), interleaved.end()};
+		}
+
+		const size_t numFrames(interleaved.size() / 2);
+
+		std::vector<int16_t> result(numFrames * 2);
+		SplitStereo(interleaved, {result.data(), numFrames}, {std::next(result.data(), static_cast<ptrdiff_t>(numFrames)), numFrames});
+		return result;
+	}
+
+	/**
+	 * \return Sum of the products of each pair of values
+	 */
+	[[nodiscard]] inline float DotProduct(const float* first, const float* second, const size_t size)
+	{
+		size_t i(0);
+		float result(0.f);
+#ifdef SIMPLE_E4B_AVX2
+		__m256 sum8(_mm256_setzero_ps());
+		for(; i + 8 <= size; i += 8)
+		{
+			sum8 = _mm256_add_ps(sum8, _mm256_mul_ps(_mm256_loadu_ps(first + i), _mm256_loadu_ps(second + i)));
+		}
+
+		__m128 sum4(_mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1)));
+#elif defined(SIMPLE_E4B_SSE2)
+		__m128 sum4(_mm_setzero_ps());
+#endif
+#ifdef SIMPLE_E4B_SSE2
+		for(; i + 4 <= size; i += 4)
+		{
+			sum4 = _mm_add_ps(sum4, _mm_mul_ps(_mm_loadu_ps(first + i), _mm_loadu_ps(second + i)));
+		}
+
+		sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+		sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+		result = _mm_cvtss_f32(sum4);
+#endif
+		for(; i < size; ++i) { result += first[i] * second[i]; }
+		return result;
+	}
+
+	/**
+	 * \brief Polyphase windowed sinc sample rate converter. Ratios which reduce to at most MAX_PHASES output phases (e.g. 44100 to 48000)
+	 * use an exact filter for each phase, other ratios interpolate between MAX_PHASES precomputed phases.
+	 */
+	struct E4Resampler final
+	{
+		static constexpr uint32_t MAX_PHASES = 1024u;
+
+		/**
+		 * \param numZeroCrossings Zero crossings of the sinc on each side of an output, more gives a sharper cutoff but is slower
+		 */
+		explicit E4Resampler(uint32_t sourceRate, uint32_t targetRate, const uint32_t numZeroCrossings = 16u)
+		{
+			assert(sourceRate > 0u && targetRate > 0u);
+			sourceRate = std::max(sourceRate, 1u);
+			targetRate = std::max(targetRate, 1u);
+
+			const uint32_t divisor(std::gcd(sourceRate, targetRate));
+			m_upFactor = targetRate / divisor;
+			m_downFactor = sourceRate / divisor;
+			m_numPhases = std::min(m_upFactor, MAX_PHASES);
+
+			// Cut off below the lower of the two Nyquist frequencies, which widens the filter by the same amount when downsampling:
+			const double bandwidth(std::min(1., static_cast<double>(m_upFactor) / static_cast<double>(m_downFactor)) * ROLLOFF);
+			m_halfTaps = static_cast<uint32_t>(std::ceil(static_cast<double>(std::max(numZeroCrossings, 1u)) / bandwidth));
+			m_halfTaps = (m_halfTaps + 3u) & ~3u; // Keeps the taps of each phase a multiple of 8 for the SIMD loops
+
+			// One extra phase a whole input sample along, so the last phase can be interpolated:
+			const size_t numTaps(GetNumTaps());
+			m_coeffs.resize((m_numPhases + 1u) * numTaps);
+			for(uint32_t phase(0u); phase <= m_numPhases; ++phase)
+			{
+				const double fraction(static_cast<double>(phase) / static_cast<double>(m_numPhases));
+				float* coeffs(std::next(m_coeffs.data(), static_cast<ptrdiff_t>(phase * numTaps)));
+
+				double sum(0.);
+				for(size_t tap(0); tap < numTaps; ++tap)
+				{
+					// Distance of the tap's input from the output, in input samples:
+					const double distance(static_cast<double>(tap) - static_cast<double>(m_halfTaps - 1u) - fraction);
+					const double coeff(Sinc(bandwidth * distance) * Kaiser(distance / static_cast<double>(m_halfTaps)));
+					coeffs[tap] = static_cast<float>(coeff);
+					sum += coeff;
+				}
+
+				// Normalize each phase to unity gain, otherwise phases differing slightly at DC would add a tone at the phase rate:
+				for(size_t tap(0); tap < numTaps; ++tap) { coeffs[tap] = static_cast<float>(coeffs[tap] / sum); }
+			}
+		}
+
+		[[nodiscard]] size_t GetOutputSize(const size_t inputSize) const
+		{
+			return static_cast<size_t>((static_cast<uint64_t>(inputSize) * m_upFactor + m_downFactor - 1u) / m_downFactor);
+		}
+
+		/**
+		 * \return The position of an input sample in the output, rounded to the nearest sample
+		 */
+		[[nodiscard]] uint32_t ConvertPosition(const uint32_t inputPosition) const
+		{
+			return static_cast<uint32_t>((static_cast<uint64_t>(inputPosition) * m_upFactor + m_downFactor / 2u) / m_downFactor);
+		}
+
+		/**
+		 * \brief Resamples one channel, output should hold GetOutputSize(input.size()) values. Input beyond either end is treated as silence.
+		 */
+		void Process(const Span<const int16_t> input, const Span<int16_t> output, E4Dither* dither = nullptr) const
+		{
+			const size_t numOutputs(GetOutputSize(input.size()));
+			assert(output.size() >= numOutputs);
+			if(output.size() < numOutputs) { return; }
+
+			const size_t numTaps(GetNumTaps());
+			
+			// Work in blocks reading roughly BLOCK_INPUTS input samples, so the float copies of the input and output stay in cache:
+			const size_t blockOutputs(std::max(static_cast<size_t>(static_cast<uint64_t>(BLOCK_INPUTS) * m_upFactor / m_downFactor), size_t(1)));
+			
+			std::vector<float> inputBlock;
+			std::vector<float> outputBlock;
+			for(size_t first(0); first < numOutputs; first += blockOutputs)
+			{
+				const size_t last(std::min(first + blockOutputs, numOutputs));
+
+				// Every input read by the block's outputs, zeroed beyond the ends of the input:
+				const int64_t windowStart(static_cast<int64_t>(GetInputIndex(first)) - static_cast<int64_t>(m_halfTaps - 1u));
+				const int64_t windowEnd(static_cast<int64_t>(GetInputIndex(last - 1u)) + static_cast<int64_t>(m_halfTaps) + 1);
+				inputBlock.assign(static_cast<size_t>(windowEnd - windowStart), 0.f);
+
+				const int64_t copyStart(std::max(windowStart, int64_t(0)));
+				const int64_t copyEnd(std::min(windowEnd, static_cast<int64_t>(input.size())));
+				if(copyEnd > copyStart)
+				{
+					const size_t copySize(static_cast<size_t>(copyEnd - copyStart));
+					ConvertToFloat(input.subspan(static_cast<size_t>(copyStart), copySize), {std::next(inputBlock.data(), copyStart - windowStart), copySize}, 1.f);
+				}
+
+				outputBlock.resize(last - first);
+				for(size_t outputIndex(first); outputIndex < last; ++outputIndex)
+				{
+					const uint64_t remainder(static_cast<uint64_t>(outputIndex) * m_downFactor % m_upFactor);
+					const float* window(std::next(inputBlock.data(), static_cast<int64_t>(GetInputIndex(outputIndex)) - static_cast<int64_t>(m_halfTaps - 1u) - windowStart));
+
+					float value;
+					if(m_numPhases == m_upFactor)
+					{
+						value = DotProduct(window, GetPhaseCoeffs(static_cast<uint32_t>(remainder)), numTaps);
+					}
+					else
+					{
+						const uint64_t phase(remainder * m_numPhases);
+						const uint32_t phaseIndex(static_cast<uint32_t>(phase / m_upFactor));
+						const float phaseFraction(static_cast<float>(phase % m_upFactor) / static_cast<float>(m_upFactor));
+						
+						const float lowPhaseValue(DotProduct(window, GetPhaseCoeffs(phaseIndex), numTaps));
+						value = lowPhaseValue + (DotProduct(window, GetPhaseCoeffs(phaseIndex + 1u), numTaps) - lowPhaseValue) * phaseFraction;
+					}
+					
+					outputBlock[outputIndex - first] = value;
+				}
+
+				ConvertToInt16(outputBlock, output.subspan(first, last - first), 1.f, dither);
+			}
+		}
+
+	private:
+		static constexpr double ROLLOFF = 0.95; // Fraction of the Nyquist frequency kept, leaving room for the transition band
+		static constexpr double KAISER_BETA = 9.; // ~90dB stopband
+		static constexpr size_t BLOCK_INPUTS = 8192;
+
+		[[nodiscard]] size_t GetNumTaps() const { return m_halfTaps * 2u; }
+
+		[[nodiscard]] size_t GetInputIndex(const size_t outputIndex) const
+		{
+			return static_cast<size_t>(static_cast<uint64_t>(outputIndex) * m_downFactor / m_upFactor);
+		}
+
+		[[nodiscard]] const float* GetPhaseCoeffs(const uint32_t phase) const
+		{
+			return std::next(m_coeffs.data(), static_cast<ptrdiff_t>(phase * GetNumTaps()));
+		}
+
+		[[nodiscard]] static double Sinc(const double x)
+		{
+			constexpr double PI(3.14159265358979323846);
+			return x == 0. ? 1. : std::sin(PI * x) / (PI * x);
+		}
+
+		// Zeroth order modified Bessel function of the first kind, from its power series:
+		[[nodiscard]] static double BesselI0(const double x)
+		{
+			double sum(1.);
+			double term(1.);
+			for(uint32_t k(1u); term > sum * 1e-12; ++k)
+			{
+				const double factor(x / (2. * static_cast<double>(k)));
+				term *= factor * factor;
+				sum += term;
+			}
+
+			return sum;
+		}
+
+		// Kaiser window over [-1, 1]:
+		[[nodiscard]] static double Kaiser(const double x)
+		{
+			if(x <= -1. || x >= 1.) { return 0.; }
+			return BesselI0(KAISER_BETA * std::sqrt(1. - x * x)) / BesselI0(KAISER_BETA);
+		}
+
+		uint32_t m_upFactor = 1u;
+		uint32_t m_downFactor = 1u;
+		uint32_t m_numPhases = 1u;
+		uint32_t m_halfTaps = 0u;
+		std::vector<float> m_coeffs{}; // Phase major, GetNumTaps() per phase
+	};
+
+	/**
+	 * \brief Converts the sample's data to targetRate, moving its loop to the same point in the new data.
+	 * \return false if the sample has no data or is already at targetRate
+	 */
+	inline bool ResampleSample(E3Sample& sample, uint32_t targetRate, const bool dither = true)
+	{
+		targetRate = std::clamp(targetRate, 7000u, 192000u);
+		
+		const uint32_t sourceRate(sample.GetSampleRate());
+		if(sourceRate == 0u || sourceRate == targetRate || sample.GetRawSampleDataSize() == 0) { return false; }
+
+		const E4Resampler resampler(sourceRate, targetRate);
+		E4Dither ditherState;
+
+		const Span<const int16_t> left(sample.GetChannelData(ESampleType::LEFT));
+		const size_t numOutputs(resampler.GetOutputSize(left.size()));
+		
+		// Kept as the left then right regions, as E3Sample stores them:
+		std::vector<int16_t> data(numOutputs * sample.GetNumChannels());
+		resampler.Process(left, {data.data(), numOutputs}, dither ? &ditherState : nullptr);
+		if(sample.GetNumChannels() == 2u)
+		{
+			const Span<const int16_t> right(sample.GetChannelData(ESampleType::RIGHT));
+			resampler.Process(right.subspan(0, std::min(right.size(), left.size())), {std::next(data.data(), static_cast<ptrdiff_t>(numOutputs)), numOutputs},
+				dither ? &ditherState : nullptr);
+		}
+
+		SampleLoopInfo loopInfo(sample.GetLoopInfo());
+		loopInfo.m_loopStart = std::min(resampler.ConvertPosition(loopInfo.m_loopStart), static_cast<uint32_t>(numOutputs));
+		loopInfo.m_loopEnd = std::min(resampler.ConvertPosition(loopInfo.m_loopEnd), static_cast<uint32_t>(numOutputs));
+
+		sample.SetSampleData(std::move(data), loopInfo);
+		sample.SetSampleRate(targetRate);
+		return true;
+	}
+
+	/**
+	 * \return Every index where the signal rises from negative to zero or above, in order
+	 */
+	[[nodiscard]] inline std::vector<uint32_t> FindRisingZeroCrossings(const Span<const float> signal)
+	{
+		std::vector<uint32_t> crossings;
+		const float* values(signal.data());
+
+		size_t i(1);
+#ifdef SIMPLE_E4B_SSE2
+		const __m128 zero(_mm_setzero_ps());
+		for(; i + 4 <= signal.size(); i += 4)
+		{
+			const __m128 previous(_mm_loadu_ps(values + i - 1));
+			const __m128 current(_mm_loadu_ps(values + i));
+			const int mask(_mm_movemask_ps(_mm_and_ps(_mm_cmplt_ps(previous, zero), _mm_cmpge_ps(current, zero))));
+			if(mask == 0) { continue; }
+
+			for(uint32_t lane(0u); lane < 4u; ++lane)
+			{
+				if((mask & (1 << lane)) != 0) { crossings.emplace_back(static_cast<uint32_t>(i + lane)); }
+			}
+		}
+#endif
+		for(; i < signal.size(); ++i)
+		{
+			if(values[i - 1] < 0.f && values[i] >= 0.f) { crossings.emplace_back(static_cast<uint32_t>(i)); }
+		}
+
+		return crossings;
+	}
+
+	/**
+	 * \brief Limits of the loop point search, lengths are in samples per channel.
+	 */
+	struct E4LoopSearchOptions final
+	{
+		// Length of the audio leading into the loop start and loop end which is compared.
+		uint32_t m_windowSize = 512u;
+
+		// Shortest loop accepted.
+		uint32_t m_minLoopLength = 2048u;
+
+		// Loop ends are only searched for in this last fraction of the sample.
+		float m_endSearchFraction = 0.25f;
+
+		// Most zero crossings tried as loop ends and as loop starts, spread evenly over those found. Every end is scored against every start.
+		uint32_t m_maxEndCandidates = 32u;
+		uint32_t m_maxStartCandidates = 256u;
+
+		// Lowest score accepted, [-1, 1] (see E4LoopPoints::m_score). Below this no loop is found, rather than a loop which clicks.
+		float m_minScore = 0.9f;
+
+		// Number of samples searched concurrently by FindAndSetLoops, 0 uses every hardware thread.
+		uint32_t m_numThreads = 1u;
+	};
+
+	struct E4LoopPoints final
+	{
+		uint32_t m_loopStart = 0u;
+		uint32_t m_loopEnd = 0u; // Exclusive, playback wraps from the sample before this back to m_loopStart
+		float m_score = -1.f; // [-1, 1] Normalized cross-correlation of the audio leading into the loop start and end, 1 being identical. The lowest of either channel for stereo samples.
+
+		[[nodiscard]] bool IsValid() const { return m_loopEnd > m_loopStart; }
+	};
+
+	/**
+	 * \brief Finds the click free loop which best matches the audio leading into its start and end.
+	 * Loop starts and ends are both placed on rising zero crossings, so the jump from end to start continues the waveform,
+	 * then each pair is scored by cross-correlating the m_windowSize samples before each point.
+	 * Stereo samples are scored on each channel separately, a pair scoring the lowest of the two, with zero crossings taken from the louder channel.
+	 * \return An invalid result if the sample has no zero crossings far enough apart, or no pair scores at least options.m_minScore
+	 */
+	[[nodiscard]] inline E4LoopPoints FindLoopPoints(const E3Sample& sample, const E4LoopSearchOptions& options = E4LoopSearchOptions())
+	{
+		const uint32_t numChannels(sample.GetNumChannels() == 2u ? 2u : 1u);
+		
+		std::array<std::vector<float>, 2> signals{};
+		for(uint32_t channel(0u); channel < numChannels; ++channel)
+		{
+			const Span<const int16_t> channelData(sample.GetChannelData(channel == 0u ? ESampleType::LEFT : ESampleType::RIGHT));
+			
+			signals[channel].resize(channelData.size());
+			ConvertToFloat(channelData, signals[channel]);
+		}
+
+		// Loop points are shared, so only the frames both channels have are searched:
+		const size_t numFrames(numChannels == 2u ? std::min(signals[0].size(), signals[1].size()) : signals[0].size());
+		
+		const size_t windowSize(std::max(options.m_windowSize, 1u));
+		const size_t minLoopLength(std::max(static_cast<size_t>(options.m_minLoopLength), size_t(1)));
+		if(numFrames < windowSize + minLoopLength) { return {}; }
+
+		size_t crossingChannel(0);
+		if(numChannels == 2u && DotProduct(signals[1].data(), signals[1].data(), numFrames) > DotProduct(signals[0].data(), signals[0].data(), numFrames)) { crossingChannel = 1u; }
+
+		const std::vector<uint32_t> crossings(FindRisingZeroCrossings({signals[crossingChannel].data(), numFrames}));
+
+		// Up to maxCount of the crossings in [first, last], evenly spread:
+		const auto pickCandidates([&crossings](const size_t first, const size_t last, const uint32_t maxCount)
+		{
+			const auto begin(std::lower_bound(crossings.begin(), crossings.end(), first));
+			const auto end(std::upper_bound(begin, crossings.end(), last));
+			
+			const size_t numInRange(static_cast<size_t>(std::distance(begin, end)));
+			const size_t numPicked(std::min(numInRange, static_cast<size_t>(maxCount)));
+
+			std::vector<uint32_t> candidates(numPicked);
+			for(size_t i(0); i < numPicked; ++i) { candidates[i] = *std::next(begin, static_cast<ptrdiff_t>(i * numInRange / numPicked)); }
+			return candidates;
+		});
+
+		const float endSearchFraction(std::clamp(options.m_endSearchFraction, 0.f, 1.f));
+		const size_t endSearchStart(std::max(static_cast<size_t>(static_cast<float>(numFrames) * (1.f - endSearchFraction)), windowSize + minLoopLength));
+		const std::vector<uint32_t> endCandidates(pickCandidates(endSearchStart, numFrames - 1u, options.m_maxEndCandidates));
+		if(endCandidates.empty()) { return {}; }
+
+		const std::vector<uint32_t> startCandidates(pickCandidates(windowSize, endCandidates.back() - minLoopLength, options.m_maxStartCandidates));
+		if(startCandidates.empty()) { return {}; }
+
+		const auto getWindow([&signals, windowSize](const uint32_t channel, const uint32_t point)
+		{
+			return std::next(signals[channel].data(), static_cast<ptrdiff_t>(point - windowSize));
+		});
+
+		// The energy of each start's window is reused against every end:
+		std::array<std::vector<float>, 2> startEnergies{};
+		for(uint32_t channel(0u); channel < numChannels; ++channel)
+		{
+			startEnergies[channel].resize(startCandidates.size());
+			for(size_t i(0); i < startCandidates.size(); ++i)
+			{
+				const float* window(getWindow(channel, startCandidates[i]));
+				startEnergies[channel][i] = DotProduct(window, window, windowSize);
+			}
+		}
+
+		constexpr float MIN_ENERGY(1e-9f);
+
+		E4LoopPoints best;
+		for(const uint32_t loopEnd : endCandidates)
+		{
+			std::array<float, 2> endEnergies{};
+			for(uint32_t channel(0u); channel < numChannels; ++channel)
+			{
+				const float* endWindow(getWindow(channel, loopEnd));
+				endEnergies[channel] = DotProduct(endWindow, endWindow, windowSize);
+			}
+
+			for(size_t i(0); i < startCandidates.size() && startCandidates[i] + minLoopLength <= loopEnd; ++i)
+			{
+				// A channel silent at both points can't click, so is left out of the score. Silent at only one, it drops to or from silence at the wrap:
+				float score(std::numeric_limits<float>::max());
+				for(uint32_t channel(0u); channel < numChannels; ++channel)
+				{
+					const bool isStartSilent(startEnergies[channel][i] < MIN_ENERGY);
+					const bool isEndSilent(endEnergies[channel] < MIN_ENERGY);
+					if(isStartSilent && isEndSilent) { continue; }
+					if(isStartSilent || isEndSilent)
+					{
+						score = std::min(score, 0.f);
+						continue;
+					}
+
+					const float channelScore(DotProduct(getWindow(channel, startCandidates[i]), getWindow(channel, loopEnd), windowSize)
+						/ std::sqrt(startEnergies[channel][i] * endEnergies[channel]));
+					score = std::min(score, channelScore);
+				}
+
+				if(score != std::numeric_limits<float>::max() && score > best.m_score)
+				{
+					best.m_loopStart = startCandidates[i];
+					best.m_loopEnd = loopEnd;
+					best.m_score = score;
+				}
+			}
+		}
+
+		if(best.m_score < options.m_minScore) { return {}; }
+		return best;
+	}
+
+	/**
+	 * \brief Sets the sample's loop to the result of FindLoopPoints and turns looping on.
+	 * \return false if no loop scoring at least options.m_minScore was found, leaving the sample as it was
+	 */
+	inline bool FindAndSetLoop(E3Sample& sample, const E4LoopSearchOptions& options = E4LoopSearchOptions())
+	{
+		const E4LoopPoints loopPoints(FindLoopPoints(sample, options));
+		if(!loopPoints.IsValid()) { return false; }
+
+		SampleLoopInfo loopInfo(sample.GetLoopInfo());
+		loopInfo.m_loop = true;
+		loopInfo.m_loopStart = loopPoints.m_loopStart;
+		loopInfo.m_loopEnd = loopPoints.m_loopEnd;
+		
+		sample.SetLoop(loopInfo);
+		return true;
+	}
+
+	/**
+	 * \brief FindAndSetLoop for each sample, spread over options.m_numThreads threads.
+	 * An exception thrown while searching is rethrown once every thread has stopped, samples which weren't reached are left as they were.
+	 * \return Number of samples which were given a loop
+	 */
+	inline size_t FindAndSetLoops(const std::vector<std::shared_ptr<E3Sample> >& samples, const E4LoopSearchOptions& options = E4LoopSearchOptions())
+	{
+		uint32_t numThreads(options.m_numThreads > 0u ? options.m_numThreads : std::max(std::thread::hardware_concurrency(), 1u));
+		numThreads = static_cast<uint32_t>(std::min(static_cast<size_t>(numThreads), std::max(samples.size(), size_t(1))));
+
+		// An exception can't leave a worker, so each thread's is kept and rethrown once they have all been joined:
+		std::vector<std::exception_ptr> exceptions(numThreads);
+		
+		std::atomic<size_t> nextSample(0);
+		std::atomic<size_t> numLooped(0);
+		const auto findLoops([&](const uint32_t threadIndex)
+		{
+			try
+			{
+				for(size_t i(nextSample++); i < samples.size(); i = nextSample++)
+				{
+					if(samples[i] != nullptr && FindAndSetLoop(*samples[i], options)) { ++numLooped; }
+				}
+			}
+			catch(...)
+			{
+				exceptions[threadIndex] = std::current_exception();
+
+				// Stop every thread from taking further samples:
+				nextSample = samples.size();
+			}
+		});
+
+		std::vector<std::thread> workers;
+		workers.reserve(numThreads - 1u);
+		for(uint32_t i(1u); i < numThreads; ++i) { workers.emplace_back(findLoops, i); }
+
+		findLoops(0u);
+		
+		for(auto& worker : workers) { worker.join(); }
+
+		for(const auto& exception : exceptions)
+		{
+			if(exception) { std::rethrow_exception(exception); }
+		}
+
+		return numLooped;
+	}
+}
\ No newline at end of file
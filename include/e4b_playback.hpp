@@ -0,0 +1,223 @@
+#pragma once
+#include "e4b_types.hpp"
+
+namespace simple_e4b
+{
+	constexpr size_t MIDI_NUM_KEYS = 128;
+	constexpr size_t MIDI_NUM_VELOCITIES = 128;
+
+	/**
+	 * \brief Location of a zone within a preset.
+	 */
+	struct E4ZoneRef final
+	{
+		uint16_t m_voice = 0ui16; // Position in the preset's voices
+		uint8_t m_zone = 0ui8; // Position in the voice's zones
+	};
+
+	/**
+	 * \brief Every zone of a preset which plays for each key and velocity, compiled from the key and velocity ranges of its voices and zones.
+	 * Realtime ranges (E4Voice::GetRTData) depend on controllers at the time, and are left to the caller.
+	 * Must be rebuilt after the preset's voices or zones are changed.
+	 */
+	struct E4ZoneLookup final
+	{
+		E4ZoneLookup() = default;
+		explicit E4ZoneLookup(const E4Preset& preset) { Build(preset); }
+
+		void Build(const E4Preset& preset)
+		{
+			m_cells.assign(MIDI_NUM_KEYS * MIDI_NUM_VELOCITIES, Cell());
+			m_zoneRefs.clear();
+
+			const auto& voices(preset.GetVoices());
+
+			std::vector<E4ZoneRef> keyZones;
+			std::vector<E4ZoneRef> cellZones;
+			for(uint8_t key(0ui8); key < MIDI_NUM_KEYS; ++key)
+			{
+				// Narrow down by key first, so each velocity only checks the zones playing this key:
+				keyZones.clear();
+				for(size_t voiceIndex(0); voiceIndex < voices.size(); ++voiceIndex)
+				{
+					const E4Voice& voice(voices[voiceIndex]);
+					if(!IsInRange(voice.GetKeyData(), key)) { continue; }
+
+					const auto& zones(voice.GetSampleZones());
+					for(size_t zoneIndex(0); zoneIndex < zones.size(); ++zoneIndex)
+					{
+						if(IsInRange(zones[zoneIndex].GetKeyData(), key))
+						{
+							keyZones.push_back({static_cast<uint16_t>(voiceIndex), static_cast<uint8_t>(zoneIndex)});
+						}
+					}
+				}
+
+				for(uint8_t velocity(0ui8); velocity < MIDI_NUM_VELOCITIES; ++velocity)
+				{
+					cellZones.clear();
+					for(const auto& zoneRef : keyZones)
+					{
+						const E4Voice& voice(voices[zoneRef.m_voice]);
+						if(IsInRange(voice.GetVelData(), velocity) && IsInRange(voice.GetSampleZones()[zoneRef.m_zone].GetVelData(), velocity))
+						{
+							cellZones.emplace_back(zoneRef);
+						}
+					}
+
+					Cell& cell(m_cells[GetCellIndex(key, velocity)]);
+
+					// Neighbouring cells usually play the same zones, so share their list rather than storing another copy:
+					if(velocity > 0ui8 && IsSameZones(m_cells[GetCellIndex(key, static_cast<uint8_t>(velocity - 1))], cellZones))
+					{
+						cell = m_cells[GetCellIndex(key, static_cast<uint8_t>(velocity - 1))];
+					}
+					else if(key > 0ui8 && IsSameZones(m_cells[GetCellIndex(static_cast<uint8_t>(key - 1), velocity)], cellZones))
+					{
+						cell = m_cells[GetCellIndex(static_cast<uint8_t>(key - 1), velocity)];
+					}
+					else
+					{
+						cell.m_offset = static_cast<uint32_t>(m_zoneRefs.size());
+						cell.m_count = static_cast<uint32_t>(cellZones.size());
+						m_zoneRefs.insert(m_zoneRefs.end(), cellZones.begin(), cellZones.end());
+					}
+				}
+			}
+		}
+
+		/**
+		 * \return Every zone playing this key and velocity, in voice and zone order
+		 */
+		[[nodiscard]] Span<const E4ZoneRef> Find(const uint8_t key, const uint8_t velocity) const
+		{
+			if(key >= MIDI_NUM_KEYS || velocity >= MIDI_NUM_VELOCITIES || m_cells.empty()) { return {}; }
+
+			const Cell& cell(m_cells[GetCellIndex(key, velocity)]);
+			return {std::next(m_zoneRefs.data(), static_cast<ptrdiff_t>(cell.m_offset)), cell.m_count};
+		}
+
+	private:
+		struct Cell final
+		{
+			uint32_t m_offset = 0u;
+			uint32_t m_count = 0u;
+		};
+
+		[[nodiscard]] static size_t GetCellIndex(const uint8_t key, const uint8_t velocity) { return key * MIDI_NUM_VELOCITIES + velocity; }
+
+		[[nodiscard]] static bool IsInRange(const E4SampleZoneNoteData& noteData, const uint8_t value)
+		{
+			return value >= noteData.GetLow() && value <= noteData.GetHigh();
+		}
+
+		[[nodiscard]] bool IsSameZones(const Cell& cell, const std::vector<E4ZoneRef>& zones) const
+		{
+			return cell.m_count == zones.size() && std::equal(zones.begin(), zones.end(), std::next(m_zoneRefs.begin(), static_cast<ptrdiff_t>(cell.m_offset)),
+				[](const E4ZoneRef& first, const E4ZoneRef& second)
+			{
+				return first.m_voice == second.m_voice && first.m_zone == second.m_zone;
+			});
+		}
+
+		std::vector<Cell> m_cells{}; // Key major
+		std::vector<E4ZoneRef> m_zoneRefs{};
+	};
+
+	/**
+	 * \brief Gain from a range's fades, which ramp linearly from its low end over lowFade values, and to its high end over highFade values.
+	 * \return [0, 1], 0 outside of the range
+	 */
+	[[nodiscard]] inline float GetCrossfadeGain(const E4SampleZoneNoteData& noteData, const uint8_t value)
+	{
+		if(value < noteData.GetLow() || value > noteData.GetHigh()) { return 0.f; }
+
+		float gain(1.f);
+		
+		const uint32_t fromLow(static_cast<uint32_t>(value - noteData.GetLow()));
+		if(fromLow < noteData.GetLowFade())
+		{
+			gain *= static_cast<float>(fromLow + 1u) / static_cast<float>(noteData.GetLowFade() + 1u);
+		}
+
+		const uint32_t fromHigh(static_cast<uint32_t>(noteData.GetHigh() - value));
+		if(fromHigh < noteData.GetHighFade())
+		{
+			gain *= static_cast<float>(fromHigh + 1u) / static_cast<float>(noteData.GetHighFade() + 1u);
+		}
+
+		return gain;
+	}
+
+	/**
+	 * \brief Crossfade gain of every zone of a preset for each key and velocity, combining the fades of the voice and of the zone.
+	 * Must be rebuilt after the preset's voices or zones are changed.
+	 */
+	struct E4CrossfadeGains final
+	{
+		E4CrossfadeGains() = default;
+		explicit E4CrossfadeGains(const E4Preset& preset) { Build(preset); }
+
+		void Build(const E4Preset& preset)
+		{
+			const auto& voices(preset.GetVoices());
+			
+			m_voiceOffsets.clear();
+			m_voiceOffsets.reserve(voices.size());
+			m_zoneGains.clear();
+			
+			for(const auto& voice : voices)
+			{
+				m_voiceOffsets.emplace_back(static_cast<uint32_t>(m_zoneGains.size()));
+				
+				for(const auto& zone : voice.GetSampleZones())
+				{
+					ZoneGains& zoneGains(m_zoneGains.emplace_back());
+					for(uint8_t value(0ui8); value < MIDI_NUM_KEYS; ++value)
+					{
+						zoneGains.m_keyGains[value] = ToFixedGain(GetCrossfadeGain(voice.GetKeyData(), value) * GetCrossfadeGain(zone.GetKeyData(), value));
+						zoneGains.m_velGains[value] = ToFixedGain(GetCrossfadeGain(voice.GetVelData(), value) * GetCrossfadeGain(zone.GetVelData(), value));
+					}
+				}
+			}
+		}
+
+		/**
+		 * \return [0, 1], the combined key and velocity crossfade gain of the zone
+		 */
+		[[nodiscard]] float GetGain(const uint16_t voiceIndex, const uint8_t zoneIndex, const uint8_t key, const uint8_t velocity) const
+		{
+			if(voiceIndex >= m_voiceOffsets.size() || key >= MIDI_NUM_KEYS || velocity >= MIDI_NUM_VELOCITIES) { return 0.f; }
+
+			const size_t zoneGainsIndex(m_voiceOffsets[voiceIndex] + zoneIndex);
+			const size_t voiceEnd(voiceIndex + 1u < m_voiceOffsets.size() ? m_voiceOffsets[voiceIndex + 1u] : m_zoneGains.size());
+			if(zoneGainsIndex >= voiceEnd) { return 0.f; }
+
+			const ZoneGains& zoneGains(m_zoneGains[zoneGainsIndex]);
+			return static_cast<float>(zoneGains.m_keyGains[key]) * static_cast<float>(zoneGains.m_velGains[velocity]) / (FIXED_GAIN_ONE * FIXED_GAIN_ONE);
+		}
+
+		[[nodiscard]] float GetGain(const E4ZoneRef& zoneRef, const uint8_t key, const uint8_t velocity) const
+		{
+			return GetGain(zoneRef.m_voice, zoneRef.m_zone, key, velocity);
+		}
+
+	private:
+		static constexpr float FIXED_GAIN_ONE = static_cast<float>(std::numeric_limits<uint16_t>::max());
+		
+		// Gains are stored as 16-bit fractions, keeping each zone to 512 bytes:
+		struct ZoneGains final
+		{
+			std::array<uint16_t, MIDI_NUM_KEYS> m_keyGains{};
+			std::array<uint16_t, MIDI_NUM_VELOCITIES> m_velGains{};
+		};
+
+		[[nodiscard]] static uint16_t ToFixedGain(const float gain)
+		{
+			return static_cast<uint16_t>(std::clamp(gain, 0.f, 1.f) * FIXED_GAIN_ONE + 0.5f);
+		}
+		
+		std::vector<uint32_t> m_voiceOffsets{}; // First of each voice's zones in m_zoneGains
+		std::vector<ZoneGains> m_zoneGains{};
+	};
+}
\ No newline at end of file
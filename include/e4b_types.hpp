@@ -3,6 +3,11 @@
 #include <cassert>
 #include <string_view>
 #include <fstream>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <type_traits>
 
 namespace byteswap_helpers
 {
@@ -43,6 +48,9 @@ namespace simple_e4b
 	constexpr size_t EOS_E4_MAX_SAMPLES = 1000;
 	constexpr size_t EOS_E4_MAX_SEQUENCES = 1000;
 	constexpr size_t EOS_E4_MAX_ZONES = 256;
+	constexpr size_t EOS_E4_VOICE_SIZE = 284; // Including the size itself
+	constexpr size_t EOS_E4_ZONE_SIZE = 22;
+	constexpr size_t EOS_E4_PRESET_SIZE = 84; // Excluding the voices
 	constexpr size_t FORM_CHUNK_MAX_NAME_LEN = 4;
 	constexpr size_t EOS_E4_MAX_NAME_LEN = 16;
 	constexpr size_t EOS_NUM_EXTRA_SAMPLE_PARAMETERS = 8;
@@ -57,6 +65,311 @@ namespace simple_e4b
 			std::replace(str.begin(), str.end(), '\0', ' ');
 		}
 	}
+
+	/**
+	 * \brief Name stored inline at the fixed length EOS uses, instead of in an allocated string.
+	 */
+	struct E4BName final
+	{
+		E4BName() = default;
+		explicit E4BName(const std::string_view name) { Assign(name); }
+
+		/**
+		 * \brief Same as ApplyEOSNamingStandards, names of any other length are truncated or padded and have nulls replaced with spaces.
+		 */
+		void Assign(const std::string_view name)
+		{
+			assert(!name.empty());
+			
+			m_data.fill('\0');
+			if(name.empty()) { return; }
+
+			std::copy_n(name.begin(), std::min(name.length(), EOS_E4_MAX_NAME_LEN), m_data.begin());
+			if(name.length() != EOS_E4_MAX_NAME_LEN)
+			{
+				std::replace(m_data.begin(), m_data.end(), '\0', ' ');
+			}
+		}
+
+		[[nodiscard]] std::string_view GetView() const { return {m_data.data(), m_data.size()}; }
+		
+		[[nodiscard]] char* data() { return m_data.data(); }
+		[[nodiscard]] const char* data() const { return m_data.data(); }
+		[[nodiscard]] static constexpr size_t size() { return EOS_E4_MAX_NAME_LEN; }
+
+		[[nodiscard]] bool operator==(const E4BName& other) const { return std::memcmp(m_data.data(), other.m_data.data(), EOS_E4_MAX_NAME_LEN) == 0; }
+		[[nodiscard]] bool operator!=(const E4BName& other) const { return !(*this == other); }
+		[[nodiscard]] bool operator<(const E4BName& other) const { return std::memcmp(m_data.data(), other.m_data.data(), EOS_E4_MAX_NAME_LEN) < 0; }
+		
+	private:
+		std::array<char, EOS_E4_MAX_NAME_LEN> m_data{};
+	};
+	
+	/**
+	 * \brief Non-owning view over contiguous elements, standing in for C++20's std::span.
+	 */
+	template<typename T>
+	struct Span final
+	{
+		constexpr Span() = default;
+		
+		constexpr Span(T* data, const size_t size) : m_data(data), m_size(size) {}
+
+		template<typename Container, typename = std::enable_if_t<std::is_convertible_v<decltype(std::declval<Container&>().data()), T*> > >
+		constexpr Span(Container& container) : m_data(container.data()), m_size(container.size()) {}
+
+		[[nodiscard]] constexpr T* data() const { return m_data; }
+		[[nodiscard]] constexpr size_t size() const { return m_size; }
+		[[nodiscard]] constexpr bool empty() const { return m_size == 0; }
+		[[nodiscard]] constexpr T* begin() const { return m_data; }
+		[[nodiscard]] constexpr T* end() const { return m_data + m_size; }
+		[[nodiscard]] constexpr T& operator[](const size_t index) const { return m_data[index]; }
+
+		[[nodiscard]] constexpr Span subspan(const size_t offset, const size_t count) const
+		{
+			assert(offset + count <= m_size);
+			return Span(m_data + offset, count);
+		}
+
+	private:
+		T* m_data = nullptr;
+		size_t m_size = 0;
+	};
+
+	/**
+	 * \brief std::vector-like container which keeps up to N elements inline, only allocating once it grows past that.
+	 */
+	template<typename T, size_t N>
+	struct SmallVector final
+	{
+		using value_type = T;
+		using iterator = T*;
+		using const_iterator = const T*;
+		
+		SmallVector() = default;
+
+		SmallVector(const SmallVector& other)
+		{
+			reserve(other.m_size);
+			std::uninitialized_copy(other.begin(), other.end(), m_data);
+			m_size = other.m_size;
+		}
+
+		SmallVector(SmallVector&& other) noexcept { MoveFrom(std::move(other)); }
+
+		~SmallVector()
+		{
+			clear();
+			FreeHeap();
+		}
+
+		SmallVector& operator=(const SmallVector& other)
+		{
+			if(this != &other)
+			{
+				clear();
+				reserve(other.m_size);
+				std::uninitialized_copy(other.begin(), other.end(), m_data);
+				m_size = other.m_size;
+			}
+
+			return *this;
+		}
+
+		SmallVector& operator=(SmallVector&& other) noexcept
+		{
+			if(this != &other)
+			{
+				clear();
+				FreeHeap();
+				MoveFrom(std::move(other));
+			}
+
+			return *this;
+		}
+
+		void reserve(const size_t capacity)
+		{
+			if(capacity <= m_capacity) { return; }
+
+			T* data(static_cast<T*>(::operator new(sizeof(T) * capacity)));
+			std::uninitialized_move(begin(), end(), data);
+			std::destroy(begin(), end());
+			
+			FreeHeap();
+			m_data = data;
+			m_capacity = capacity;
+		}
+		
+		template<typename... Args>
+		T& emplace_back(Args&&... args)
+		{
+			if(m_size == m_capacity)
+			{
+				// The arguments may refer to an element, so construct before reallocating:
+				T value(std::forward<Args>(args)...);
+				reserve(m_capacity * 2u);
+				
+				return *new(std::next(m_data, static_cast<ptrdiff_t>(m_size++))) T(std::move(value));
+			}
+
+			return *new(std::next(m_data, static_cast<ptrdiff_t>(m_size++))) T(std::forward<Args>(args)...);
+		}
+
+		void push_back(const T& value) { emplace_back(value); }
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+
+		void pop_back()
+		{
+			assert(m_size > 0);
+			std::destroy_at(std::next(m_data, static_cast<ptrdiff_t>(--m_size)));
+		}
+		
+		iterator erase(const const_iterator first, const const_iterator last)
+		{
+			T* eraseStart(const_cast<T*>(first));
+			T* newEnd(std::move(const_cast<T*>(last), end(), eraseStart));
+			
+			std::destroy(newEnd, end());
+			m_size = static_cast<size_t>(std::distance(begin(), newEnd));
+			
+			return eraseStart;
+		}
+
+		iterator erase(const const_iterator iter) { return erase(iter, std::next(iter)); }
+
+		void clear()
+		{
+			std::destroy(begin(), end());
+			m_size = 0;
+		}
+
+		[[nodiscard]] T* data() { return m_data; }
+		[[nodiscard]] const T* data() const { return m_data; }
+		[[nodiscard]] size_t size() const { return m_size; }
+		[[nodiscard]] size_t capacity() const { return m_capacity; }
+		[[nodiscard]] bool empty() const { return m_size == 0; }
+		[[nodiscard]] iterator begin() { return m_data; }
+		[[nodiscard]] iterator end() { return std::next(m_data, static_cast<ptrdiff_t>(m_size)); }
+		[[nodiscard]] const_iterator begin() const { return m_data; }
+		[[nodiscard]] const_iterator end() const { return std::next(m_data, static_cast<ptrdiff_t>(m_size)); }
+		[[nodiscard]] T& operator[](const size_t index) { return m_data[index]; }
+		[[nodiscard]] const T& operator[](const size_t index) const { return m_data[index]; }
+		[[nodiscard]] T& front() { return m_data[0]; }
+		[[nodiscard]] const T& front() const { return m_data[0]; }
+		[[nodiscard]] T& back() { return m_data[m_size - 1u]; }
+		[[nodiscard]] const T& back() const { return m_data[m_size - 1u]; }
+
+	private:
+		[[nodiscard]] T* GetInlineData() { return reinterpret_cast<T*>(m_inlineData); }
+		[[nodiscard]] bool IsInline() const { return m_data == reinterpret_cast<const T*>(m_inlineData); }
+
+		void FreeHeap()
+		{
+			if(!IsInline())
+			{
+				::operator delete(m_data);
+				m_data = GetInlineData();
+				m_capacity = N;
+			}
+		}
+
+		// Expects to be empty and inline:
+		void MoveFrom(SmallVector&& other)
+		{
+			if(other.IsInline())
+			{
+				std::uninitialized_move(other.begin(), other.end(), m_data);
+				m_size = other.m_size;
+				other.clear();
+			}
+			else
+			{
+				m_data = other.m_data;
+				m_size = other.m_size;
+				m_capacity = other.m_capacity;
+
+				other.m_data = other.GetInlineData();
+				other.m_size = 0;
+				other.m_capacity = N;
+			}
+		}
+		
+		alignas(T) unsigned char m_inlineData[sizeof(T) * N];
+		T* m_data = GetInlineData();
+		size_t m_size = 0;
+		size_t m_capacity = N;
+	};
+	
+	/*
+	 * Streams:
+	 */
+
+	/**
+	 * \brief std::istream-like cursor over a contiguous block of memory, so chunks can be parsed without iostream overhead.
+	 * When an owner is provided (e.g. a file mapping), chunks may keep views into the memory instead of copying it.
+	 */
+	struct MemoryStream final
+	{
+		MemoryStream() = default;
+
+		explicit MemoryStream(const char* data, const size_t size, std::shared_ptr<const void> owner = nullptr)
+			: m_data(data), m_size(size), m_owner(std::move(owner)) {}
+
+		explicit MemoryStream(const Span<const char> data, std::shared_ptr<const void> owner = nullptr)
+			: m_data(data.data()), m_size(data.size()), m_owner(std::move(owner)) {}
+
+		void read(char* data, const std::streamsize count)
+		{
+			const size_t readSize(std::min(static_cast<size_t>(count), GetRemaining()));
+			if(readSize > 0)
+			{
+				std::memcpy(data, std::next(m_data, static_cast<ptrdiff_t>(m_pos)), readSize);	
+			}
+			
+			m_pos += readSize;
+			m_lastReadSize = readSize;
+			if(readSize < static_cast<size_t>(count)) { m_eof = true; }
+		}
+
+		void ignore(const std::streamsize count = 1)
+		{
+			const size_t ignoreSize(std::min(static_cast<size_t>(count), GetRemaining()));
+			m_pos += ignoreSize;
+			if(ignoreSize < static_cast<size_t>(count)) { m_eof = true; }
+		}
+
+		void seekg(const std::streamoff pos)
+		{
+			m_pos = std::min(static_cast<size_t>(pos), m_size);
+			m_eof = false;
+		}
+
+		[[nodiscard]] std::streamoff tellg() const { return static_cast<std::streamoff>(m_pos); }
+		[[nodiscard]] bool eof() const { return m_eof; }
+
+		/**
+		 * \return Number of bytes the last read copied, as with std::istream
+		 */
+		[[nodiscard]] std::streamsize gcount() const { return static_cast<std::streamsize>(m_lastReadSize); }
+
+		/**
+		 * \return Pointer to the data at the current position, valid for GetRemaining() bytes
+		 */
+		[[nodiscard]] const char* GetCurrent() const { return std::next(m_data, static_cast<ptrdiff_t>(m_pos)); }
+		[[nodiscard]] size_t GetRemaining() const { return m_size - m_pos; }
+		[[nodiscard]] const std::shared_ptr<const void>& GetOwner() const { return m_owner; }
+
+	private:
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+		size_t m_pos = 0;
+		size_t m_lastReadSize = 0;
+		bool m_eof = false;
+
+		// Keeps the memory alive for views taken from this stream, can be empty.
+		std::shared_ptr<const void> m_owner{};
+	};
 	
 	/*
 	 * Chunks:
@@ -69,7 +382,8 @@ namespace simple_e4b
 		explicit FORMChunk(std::string&& chunkName, const uint32_t chunkSize = 0u)
 			: m_chunkName(std::move(chunkName)), m_readChunkSize(chunkSize) {}
 		
-		void Write(std::ofstream& stream) const
+		template<typename Stream>
+		void Write(Stream& stream) const
 		{
 			if(m_chunkName.length() != FORM_CHUNK_MAX_NAME_LEN)
 			{
@@ -79,7 +393,7 @@ namespace simple_e4b
 			
 			stream.write(m_chunkName.data(), FORM_CHUNK_MAX_NAME_LEN);
 
-			// We override the chunk size here specifically for the TOC subchunks.
+			// We override the chunk size here specifically for the TOC subchunks, and for chunks with data written separately.
 			const uint32_t chunkSize(byteswap_helpers::byteswap_uint32(m_readChunkSize > 0u ? m_readChunkSize : GetFullSize(true) - 8u));
 			stream.write(reinterpret_cast<const char*>(&chunkSize), sizeof(uint32_t));
 
@@ -94,7 +408,8 @@ namespace simple_e4b
 			}
 		}
 		
-		void Read(std::ifstream& stream)
+		template<typename Stream>
+		void Read(Stream& stream)
 		{
 			m_chunkName.clear();
 			m_chunkName.resize(FORM_CHUNK_MAX_NAME_LEN);
@@ -106,6 +421,11 @@ namespace simple_e4b
 
 		[[nodiscard]] std::string_view GetName() const { return m_chunkName; }
 
+		/**
+		 * \return Data written to this chunk so far, excluding subchunks
+		 */
+		[[nodiscard]] Span<const char> GetWrittenData() const { return m_writtenData; }
+
 		[[nodiscard]] uint32_t GetReadSize() const
 		{
 			return m_readChunkSize;
@@ -136,21 +456,36 @@ namespace simple_e4b
 			assert(size > 0);
 			if(size > 0)
 			{
-				if (m_writtenData.size() + size > m_writtenData.size())
-				{
-					m_writtenData.resize(m_writtenData.size() + size);
-				}
+				// Grow geometrically ourselves, so many small writes don't rely on the container's resize policy:
+				Reserve(size);
 
 				if(data != nullptr)
 				{
-					char* iterator(std::next(m_writtenData.data(), static_cast<ptrdiff_t>(m_writeLocation)));
-					std::memcpy(iterator, data, size);
+					const char* bytes(reinterpret_cast<const char*>(data));
+					m_writtenData.insert(m_writtenData.end(), bytes, std::next(bytes, static_cast<ptrdiff_t>(size)));
+				}
+				else
+				{
+					m_writtenData.insert(m_writtenData.end(), size, '\0');
 				}
 
 				m_writeLocation += size;	
 			}
 		}
 
+		/**
+		 * \brief Ensures that numBytes more can be written without reallocating.
+		 * Grows geometrically like writeType, so reserving ahead of each of many writes stays linear overall.
+		 */
+		void Reserve(const size_t numBytes)
+		{
+			const size_t requiredSize(m_writtenData.size() + numBytes);
+			if(requiredSize > m_writtenData.capacity())
+			{
+				m_writtenData.reserve(std::max(requiredSize, m_writtenData.capacity() * 2u));
+			}
+		}
+
 		std::vector<FORMChunk> m_subChunks{};
 
 	private:
@@ -354,7 +689,8 @@ namespace simple_e4b
 			presetChunk.writeType(null, 7);
 		}
 		
-		void Read(std::ifstream& stream)
+		template<typename Stream>
+		void Read(Stream& stream)
 		{
 			stream.read(reinterpret_cast<char*>(&m_keyData), sizeof(E4SampleZoneNoteData));
 			stream.read(reinterpret_cast<char*>(&m_velData), sizeof(E4SampleZoneNoteData));
@@ -364,12 +700,12 @@ namespace simple_e4b
 
 			stream.ignore(1);
 
-			int8_t fineTune;
+			int8_t fineTune(0i8);
 			stream.read(reinterpret_cast<char*>(&fineTune), sizeof(int8_t));
 
 			m_fineTune = unit_helpers::ConvertByteToFineTune(fineTune);
 
-			uint8_t originalKey;
+			uint8_t originalKey(0ui8);
 			stream.read(reinterpret_cast<char*>(&originalKey), sizeof(uint8_t));
 
 			m_originalKey = MidiNote(originalKey);
@@ -471,21 +807,22 @@ namespace simple_e4b
 			presetChunk.writeType(null, 2);
 		}
 		
-		void Read(std::ifstream& stream)
+		template<typename Stream>
+		void Read(Stream& stream)
 		{
-			uint8_t rate;
+			uint8_t rate(0ui8);
 			stream.read(reinterpret_cast<char*>(&rate), sizeof(uint8_t));
 
 			m_rate = unit_helpers::GetLFORateFromByte(rate);
 			
 			stream.read(reinterpret_cast<char*>(&m_shape), sizeof(E4LFOShape));
 
-			uint8_t delay;
+			uint8_t delay(0ui8);
 			stream.read(reinterpret_cast<char*>(&delay), sizeof(uint8_t));
 
 			m_delay = unit_helpers::GetLFODelayFromByte(delay);
 
-			uint8_t variation;
+			uint8_t variation(0ui8);
 			stream.read(reinterpret_cast<char*>(&variation), sizeof(uint8_t));
 
 			m_variationPercent = unit_helpers::ConvertByteToPercentF(variation);
@@ -619,12 +956,13 @@ namespace simple_e4b
 			presetChunk.writeType(reinterpret_cast<const char*>(&unknown), sizeof(uint8_t));
 		}
 		
-		void Read(std::ifstream& stream)
+		template<typename Stream>
+		void Read(Stream& stream)
 		{
 			stream.read(reinterpret_cast<char*>(&m_src), sizeof(EEOSCordSource));
 			stream.read(reinterpret_cast<char*>(&m_dst), sizeof(EEOSCordDest));
 
-			int8_t amt;
+			int8_t amt(0i8);
 			stream.read(reinterpret_cast<char*>(&amt), sizeof(int8_t));
 
 			m_percent = unit_helpers::ConvertByteToPercentF(amt);
@@ -695,13 +1033,19 @@ namespace simple_e4b
 		POLY_REL_TRIG_NOTE_VEL_2
 	};
 
+	// Most voices only have a few zones, which are then kept inline in the voice.
+	constexpr size_t EOS_E4_NUM_INLINE_ZONES = 4;
+	using E4SampleZones = SmallVector<E4SampleZone, EOS_E4_NUM_INLINE_ZONES>;
+	
 	struct E4Voice final
 	{
 		E4Voice() = default;
 
 		void Write(FORMChunk& presetChunk) const
 		{
-			const uint16_t voiceDataSize(byteswap_helpers::byteswap_uint16(static_cast<uint16_t>(284 + 22 * m_zones.size())));
+			presetChunk.Reserve(GetWriteSize());
+			
+			const uint16_t voiceDataSize(byteswap_helpers::byteswap_uint16(static_cast<uint16_t>(GetWriteSize())));
 			presetChunk.writeType(reinterpret_cast<const char*>(&voiceDataSize), sizeof(uint16_t));
 
 			const uint8_t zoneCount(static_cast<uint8_t>(m_zones.size()));
@@ -808,7 +1152,8 @@ namespace simple_e4b
 			}
 		}
 		
-		void Read(std::ifstream& stream)
+		template<typename Stream>
+		void Read(Stream& stream)
 		{
 			uint16_t voiceDataSize(0ui16);
 			stream.read(reinterpret_cast<char*>(&voiceDataSize), sizeof(uint16_t));
@@ -820,200 +1165,123 @@ namespace simple_e4b
 				return;
 			}
 
-			uint8_t zoneCount(0ui8);
-			stream.read(reinterpret_cast<char*>(&zoneCount), sizeof(uint8_t));
-
-			assert(zoneCount > 0ui8);
-			if(zoneCount == 0ui8)
+			// The rest of the voice is a fixed size header followed by a fixed size per zone,
+			// so it is read in one go and decoded from memory rather than field by field.
+			const size_t recordSize(voiceDataSize - sizeof(uint16_t));
+			
+			assert(voiceDataSize <= EOS_E4_VOICE_SIZE + EOS_E4_ZONE_SIZE * std::numeric_limits<uint8_t>::max());
+			if(voiceDataSize > EOS_E4_VOICE_SIZE + EOS_E4_ZONE_SIZE * std::numeric_limits<uint8_t>::max())
 			{
 				return;
 			}
-			
-			stream.read(reinterpret_cast<char*>(&m_group), sizeof(uint8_t));
-
-			stream.ignore(8);
 
-			stream.read(reinterpret_cast<char*>(&m_keyData), sizeof(E4SampleZoneNoteData));
-			stream.read(reinterpret_cast<char*>(&m_velData), sizeof(E4SampleZoneNoteData));
-			stream.read(reinterpret_cast<char*>(&m_rtData), sizeof(E4SampleZoneNoteData));
+			if constexpr(std::is_same_v<Stream, MemoryStream>)
+			{
+				if(stream.GetRemaining() >= recordSize)
+				{
+					MemoryStream record(stream.GetCurrent(), recordSize);
+					stream.ignore(static_cast<std::streamsize>(recordSize));
+					
+					ReadRecord(record);
+					return;
+				}
+			}
 
-			stream.ignore(1);
-			
-			stream.read(reinterpret_cast<char*>(&m_keyAssignGroup), sizeof(EEOSAssignGroup));
-			
-			stream.read(reinterpret_cast<char*>(&m_keyDelay), sizeof(uint16_t));
-			m_keyDelay = byteswap_helpers::byteswap_uint16(m_keyDelay);
+			std::array<char, EOS_E4_VOICE_SIZE + EOS_E4_ZONE_SIZE * std::numeric_limits<uint8_t>::max()> recordData{};
+			stream.read(recordData.data(), static_cast<std::streamsize>(recordSize));
 
-			stream.ignore(3);
+			// A truncated record keeps the voice's defaults rather than decoding part of it:
+			if(static_cast<size_t>(stream.gcount()) != recordSize) { return; }
 
-			uint8_t sampleOffset;
-			stream.read(reinterpret_cast<char*>(&sampleOffset), sizeof(uint8_t));
+			MemoryStream record(recordData.data(), recordSize);
+			ReadRecord(record);
+		}
 
-			m_sampleOffset = unit_helpers::ConvertByteToPercentF(sampleOffset);
+		/**
+		 * \brief Reads the voice without its zones, which directly follow in the stream and can be read one by one with E4SampleZone::Read.
+		 * \return Number of zones following the voice, 0 when invalid
+		 */
+		uint8_t ReadWithoutZones(MemoryStream& stream)
+		{
+			uint16_t voiceDataSize(0ui16);
+			stream.read(reinterpret_cast<char*>(&voiceDataSize), sizeof(uint16_t));
+			voiceDataSize = byteswap_helpers::byteswap_uint16(voiceDataSize);
 			
-			stream.read(reinterpret_cast<char*>(&m_transpose), sizeof(int8_t));
-			stream.read(reinterpret_cast<char*>(&m_coarseTune), sizeof(int8_t));
-
-			int8_t fineTune;
-			stream.read(reinterpret_cast<char*>(&fineTune), sizeof(int8_t));
+			assert(voiceDataSize % 22 == 20);
+			if(voiceDataSize % 22 != 20 || stream.GetRemaining() < voiceDataSize - sizeof(uint16_t))
+			{
+				return 0ui8;
+			}
 
-			m_fineTune = unit_helpers::ConvertByteToFineTune(fineTune);
-			
-			stream.read(reinterpret_cast<char*>(&m_glideRate), sizeof(uint8_t));
-			stream.read(reinterpret_cast<char*>(&m_fixedPitch), sizeof(bool));
-			stream.read(reinterpret_cast<char*>(&m_keyMode), sizeof(EEOSKeyMode));
+			return ReadRecordHeader(stream);
+		}
 
-			stream.ignore(1);
+		[[nodiscard]] bool GetPercentFromCord(const EEOSCordSource src, const EEOSCordDest dst, float& outPercent) const
+		{
+			for(const auto& cord : m_cords)
+			{
+				if(cord.GetSrc() == src && cord.GetDst() == dst)
+				{
+					outPercent = cord.GetPercent();
+					return true;
+				}
+			}
 
-			uint8_t chorusWidth;
-			stream.read(reinterpret_cast<char*>(&chorusWidth), sizeof(uint8_t));
+			return false;
+		}
 
-			m_chorusWidth = unit_helpers::GetChorusWidthPercent(chorusWidth);
+		[[nodiscard]] bool HasCord(const EEOSCordSource src) const
+		{
+			for(const auto& cord : m_cords) { if(cord.GetSrc() == src) { return true; } }
+			return false;
+		}
 
-			uint8_t chorusAmt;
-			stream.read(reinterpret_cast<char*>(&chorusAmt), sizeof(uint8_t));
+		void ReplaceOrAddCord(const E4Cord& cord)
+		{
+			// Replace if existing
+			for(auto& existingCord : m_cords)
+			{
+				if(existingCord.GetSrc() == cord.GetSrc() && existingCord.GetDst() == cord.GetDst())
+				{
+					existingCord.SetPercent(cord.GetPercent());
+					return;
+				}
+			}
 
-			m_chorusAmount = unit_helpers::round_f_places(unit_helpers::ConvertByteToPercentF(chorusAmt), 2u);
+			// Replace null cord
+			for(auto& existingCord : m_cords)
+			{
+				if(existingCord.GetSrc() == EEOSCordSource::SRC_OFF && existingCord.GetDst() == EEOSCordDest::DST_OFF)
+				{
+					existingCord = cord;
+					break;
+				}
+			}
+		}
 
-			stream.ignore(1);
-
-			stream.read(reinterpret_cast<char*>(&m_chorusInitItd), sizeof(uint8_t));
-			
-			stream.ignore(5);
-
-			stream.read(reinterpret_cast<char*>(&m_keyLatch), sizeof(bool));
-
-			stream.ignore(2);
-
-			stream.read(reinterpret_cast<char*>(&m_glideCurveType), sizeof(EEOSGlideCurveType));
-			stream.read(reinterpret_cast<char*>(&m_volume), sizeof(int8_t));
-			stream.read(reinterpret_cast<char*>(&m_pan), sizeof(int8_t));
-			
-			stream.ignore(1);
-			
-			stream.read(reinterpret_cast<char*>(&m_ampEnvDynRange), sizeof(int8_t));
-			stream.read(reinterpret_cast<char*>(&m_filterType), sizeof(EEOSFilterType));
-			
-			stream.ignore(1);
-
-			uint8_t filterFreq;
-			stream.read(reinterpret_cast<char*>(&filterFreq), sizeof(uint8_t));
-
-			m_filterFrequency = unit_helpers::ConvertByteToFilterFrequency(filterFreq);
-			
-			uint8_t filterRes;
-			stream.read(reinterpret_cast<char*>(&filterRes), sizeof(uint8_t));
-
-			m_filterResonance = unit_helpers::round_f_places(unit_helpers::ConvertByteToPercentF(filterRes), 1u);
-
-			stream.ignore(48);
-
-			stream.read(reinterpret_cast<char*>(&m_ampEnv), sizeof(E4Envelope));
-
-			stream.ignore(2);
-			
-			stream.read(reinterpret_cast<char*>(&m_filterEnv), sizeof(E4Envelope));
-
-			stream.ignore(2);
-			
-			stream.read(reinterpret_cast<char*>(&m_auxEnv), sizeof(E4Envelope));
-
-			stream.ignore(2);
-
-			m_lfo1.Read(stream);
-
-			stream.ignore(1);
-			
-			m_lfo2.Read(stream);
-
-			stream.read(reinterpret_cast<char*>(&m_lfoLag1), sizeof(uint8_t));
-			
-			stream.ignore(1);
-			
-			stream.read(reinterpret_cast<char*>(&m_lfoLag2), sizeof(uint8_t));
-
-			stream.ignore(20);
-
-			for(auto& cord : m_cords)
-			{
-				cord.Read(stream);
-			}
-
-			for(uint8_t i(0ui8); i < zoneCount; ++i)
-			{
-				E4SampleZone zone;
-				zone.Read(stream);
-
-				m_zones.emplace_back(std::move(zone));
-			}
-		}
-
-		[[nodiscard]] bool GetPercentFromCord(const EEOSCordSource src, const EEOSCordDest dst, float& outPercent) const
-		{
-			for(const auto& cord : m_cords)
-			{
-				if(cord.GetSrc() == src && cord.GetDst() == dst)
-				{
-					outPercent = cord.GetPercent();
-					return true;
-				}
-			}
-
-			return false;
-		}
-
-		[[nodiscard]] bool HasCord(const EEOSCordSource src) const
-		{
-			for(const auto& cord : m_cords) { if(cord.GetSrc() == src) { return true; } }
-			return false;
-		}
-
-		void ReplaceOrAddCord(const E4Cord& cord)
-		{
-			// Replace if existing
-			for(auto& existingCord : m_cords)
-			{
-				if(existingCord.GetSrc() == cord.GetSrc() && existingCord.GetDst() == cord.GetDst())
-				{
-					existingCord.SetPercent(cord.GetPercent());
-					return;
-				}
-			}
-
-			// Replace null cord
-			for(auto& existingCord : m_cords)
-			{
-				if(existingCord.GetSrc() == EEOSCordSource::SRC_OFF && existingCord.GetDst() == EEOSCordDest::DST_OFF)
-				{
-					existingCord = cord;
-					break;
-				}
-			}
-		}
-
-		void SetGroup(const uint8_t group) { m_group = std::clamp(group, 0ui8, 31ui8); }
-		void SetKeyData(const E4SampleZoneNoteData data) { m_keyData = data; }
-		
-		void SetVelData(const E4SampleZoneNoteData data) { m_velData = data; }
-		void SetRTData(const E4SampleZoneNoteData data) { m_rtData = data; }
-		void SetKeyAssignGroup(const EEOSAssignGroup group) { m_keyAssignGroup = group; }
-		void SetKeyDelay(const uint16_t milliseconds) { m_keyDelay = std::clamp(milliseconds, 0ui16, 10000ui16); }
-		void SetSampleOffset(const float offset) { m_sampleOffset = offset; }
-		void SetTranspose(const int8_t cents) { m_transpose = std::clamp(cents, MIN_TRANSPOSE_BYTE, MAX_TRANSPOSE_BYTE); }
-		void SetCoarseTune(const int8_t cents) { m_coarseTune = std::clamp(cents, MIN_COARSE_TUNE_BYTE, MAX_COARSE_TUNE_BYTE); }
-		void SetFineTune(const double fineTune) { m_fineTune = std::clamp(fineTune, -100.0, 100.0); }
-		void SetIsFixedPitch(const bool arg) { m_fixedPitch = arg; }
-		void SetKeyMode(const EEOSKeyMode mode) { m_keyMode = mode; }
-		void SetChorusWidth(const float percent) { m_chorusWidth = std::clamp(percent, 0.f, 100.f); }
-		void SetChorusAmount(const float percent) { m_chorusAmount = std::clamp(percent, 0.f, 100.f); }
-		void SetGlideCurveType(const EEOSGlideCurveType type) { m_glideCurveType = type; }
-		void SetVolume(const int8_t dB) { m_volume = std::clamp(dB, MIN_VOLUME_BYTE, MAX_VOLUME_BYTE); }
-		void SetPan(const int8_t pan) { m_pan = std::clamp(pan, MIN_PAN_BYTE, MAX_PAN_BYTE); }
-		void SetFilterType(const EEOSFilterType type) { m_filterType = type; }
-		void SetFilterFrequency(const uint16_t hertz) { m_filterFrequency = std::clamp(hertz, MIN_FILTER_FREQUENCY, MAX_FILTER_FREQUENCY); }
-		void SetFilterResonance(const float percent) { m_filterResonance = std::clamp(percent, 0.f, 100.f); }
-		void SetLFOLag1(const uint8_t lag) { m_lfoLag1 = std::clamp(lag, MIN_LFO_LAG_BYTE, MAX_LFO_LAG_BYTE); }
-		void SetLFOLag2(const uint8_t lag) { m_lfoLag2 = std::clamp(lag, MIN_LFO_LAG_BYTE, MAX_LFO_LAG_BYTE); }
+		void SetGroup(const uint8_t group) { m_group = std::clamp(group, 0ui8, 31ui8); }
+		void SetKeyData(const E4SampleZoneNoteData data) { m_keyData = data; }
+		
+		void SetVelData(const E4SampleZoneNoteData data) { m_velData = data; }
+		void SetRTData(const E4SampleZoneNoteData data) { m_rtData = data; }
+		void SetKeyAssignGroup(const EEOSAssignGroup group) { m_keyAssignGroup = group; }
+		void SetKeyDelay(const uint16_t milliseconds) { m_keyDelay = std::clamp(milliseconds, 0ui16, 10000ui16); }
+		void SetSampleOffset(const float offset) { m_sampleOffset = offset; }
+		void SetTranspose(const int8_t cents) { m_transpose = std::clamp(cents, MIN_TRANSPOSE_BYTE, MAX_TRANSPOSE_BYTE); }
+		void SetCoarseTune(const int8_t cents) { m_coarseTune = std::clamp(cents, MIN_COARSE_TUNE_BYTE, MAX_COARSE_TUNE_BYTE); }
+		void SetFineTune(const double fineTune) { m_fineTune = std::clamp(fineTune, -100.0, 100.0); }
+		void SetIsFixedPitch(const bool arg) { m_fixedPitch = arg; }
+		void SetKeyMode(const EEOSKeyMode mode) { m_keyMode = mode; }
+		void SetChorusWidth(const float percent) { m_chorusWidth = std::clamp(percent, 0.f, 100.f); }
+		void SetChorusAmount(const float percent) { m_chorusAmount = std::clamp(percent, 0.f, 100.f); }
+		void SetGlideCurveType(const EEOSGlideCurveType type) { m_glideCurveType = type; }
+		void SetVolume(const int8_t dB) { m_volume = std::clamp(dB, MIN_VOLUME_BYTE, MAX_VOLUME_BYTE); }
+		void SetPan(const int8_t pan) { m_pan = std::clamp(pan, MIN_PAN_BYTE, MAX_PAN_BYTE); }
+		void SetFilterType(const EEOSFilterType type) { m_filterType = type; }
+		void SetFilterFrequency(const uint16_t hertz) { m_filterFrequency = std::clamp(hertz, MIN_FILTER_FREQUENCY, MAX_FILTER_FREQUENCY); }
+		void SetFilterResonance(const float percent) { m_filterResonance = std::clamp(percent, 0.f, 100.f); }
+		void SetLFOLag1(const uint8_t lag) { m_lfoLag1 = std::clamp(lag, MIN_LFO_LAG_BYTE, MAX_LFO_LAG_BYTE); }
+		void SetLFOLag2(const uint8_t lag) { m_lfoLag2 = std::clamp(lag, MIN_LFO_LAG_BYTE, MAX_LFO_LAG_BYTE); }
 
 		void AddSampleZone(E4SampleZone&& zone)
 		{
@@ -1024,7 +1292,7 @@ namespace simple_e4b
 			}
 		}
 
-		void RemoveSampleZone(const std::vector<E4SampleZone>::const_iterator& iter)
+		void RemoveSampleZone(const E4SampleZones::const_iterator& iter)
 		{
 			m_zones.erase(iter);
 		}
@@ -1106,7 +1374,13 @@ namespace simple_e4b
 		[[nodiscard]] uint8_t GetLFOLag1() const { return m_lfoLag1; }
 		[[nodiscard]] uint8_t GetLFOLag2() const { return m_lfoLag2; }
 		[[nodiscard]] std::array<E4Cord, 24>& GetCords() { return m_cords; }
-		[[nodiscard]] const std::vector<E4SampleZone>& GetSampleZones() const { return m_zones; }
+		[[nodiscard]] E4SampleZones& GetSampleZones() { return m_zones; }
+		[[nodiscard]] const E4SampleZones& GetSampleZones() const { return m_zones; }
+
+		/**
+		 * \return Number of bytes Write will produce, including the size
+		 */
+		[[nodiscard]] size_t GetWriteSize() const { return EOS_E4_VOICE_SIZE + EOS_E4_ZONE_SIZE * m_zones.size(); }
 		
 	private:
 		uint8_t m_group = 0ui8; // [0 (1), 31 (32)]
@@ -1160,13 +1434,503 @@ namespace simple_e4b
 		 * Allocated data
 		 */
 		
-		std::vector<E4SampleZone> m_zones{};
+		E4SampleZones m_zones{};
+
+		// Decodes everything following the voice data size.
+		void ReadRecord(MemoryStream& stream)
+		{
+			const uint8_t zoneCount(ReadRecordHeader(stream));
+
+			m_zones.reserve(zoneCount);
+			for(uint8_t i(0ui8); i < zoneCount; ++i)
+			{
+				E4SampleZone zone;
+				zone.Read(stream);
+
+				m_zones.emplace_back(std::move(zone));
+			}
+		}
+
+		// Decodes everything following the voice data size up to the zones.
+		// Returns the number of zones following, 0 when invalid.
+		uint8_t ReadRecordHeader(MemoryStream& stream)
+		{
+			uint8_t zoneCount(0ui8);
+			stream.read(reinterpret_cast<char*>(&zoneCount), sizeof(uint8_t));
+
+			assert(zoneCount > 0ui8);
+			if(zoneCount == 0ui8)
+			{
+				return 0ui8;
+			}
+			
+			stream.read(reinterpret_cast<char*>(&m_group), sizeof(uint8_t));
+
+			stream.ignore(8);
+
+			stream.read(reinterpret_cast<char*>(&m_keyData), sizeof(E4SampleZoneNoteData));
+			stream.read(reinterpret_cast<char*>(&m_velData), sizeof(E4SampleZoneNoteData));
+			stream.read(reinterpret_cast<char*>(&m_rtData), sizeof(E4SampleZoneNoteData));
+
+			stream.ignore(1);
+			
+			stream.read(reinterpret_cast<char*>(&m_keyAssignGroup), sizeof(EEOSAssignGroup));
+			
+			stream.read(reinterpret_cast<char*>(&m_keyDelay), sizeof(uint16_t));
+			m_keyDelay = byteswap_helpers::byteswap_uint16(m_keyDelay);
+
+			stream.ignore(3);
+
+			uint8_t sampleOffset(0ui8);
+			stream.read(reinterpret_cast<char*>(&sampleOffset), sizeof(uint8_t));
+
+			m_sampleOffset = unit_helpers::ConvertByteToPercentF(sampleOffset);
+			
+			stream.read(reinterpret_cast<char*>(&m_transpose), sizeof(int8_t));
+			stream.read(reinterpret_cast<char*>(&m_coarseTune), sizeof(int8_t));
+
+			int8_t fineTune(0i8);
+			stream.read(reinterpret_cast<char*>(&fineTune), sizeof(int8_t));
+
+			m_fineTune = unit_helpers::ConvertByteToFineTune(fineTune);
+			
+			stream.read(reinterpret_cast<char*>(&m_glideRate), sizeof(uint8_t));
+			stream.read(reinterpret_cast<char*>(&m_fixedPitch), sizeof(bool));
+			stream.read(reinterpret_cast<char*>(&m_keyMode), sizeof(EEOSKeyMode));
+
+			stream.ignore(1);
+
+			uint8_t chorusWidth(0ui8);
+			stream.read(reinterpret_cast<char*>(&chorusWidth), sizeof(uint8_t));
+
+			m_chorusWidth = unit_helpers::GetChorusWidthPercent(chorusWidth);
+
+			uint8_t chorusAmt(0ui8);
+			stream.read(reinterpret_cast<char*>(&chorusAmt), sizeof(uint8_t));
+
+			m_chorusAmount = unit_helpers::round_f_places(unit_helpers::ConvertByteToPercentF(chorusAmt), 2u);
+
+			stream.ignore(1);
+
+			stream.read(reinterpret_cast<char*>(&m_chorusInitItd), sizeof(uint8_t));
+			
+			stream.ignore(5);
+
+			stream.read(reinterpret_cast<char*>(&m_keyLatch), sizeof(bool));
+
+			stream.ignore(2);
+
+			stream.read(reinterpret_cast<char*>(&m_glideCurveType), sizeof(EEOSGlideCurveType));
+			stream.read(reinterpret_cast<char*>(&m_volume), sizeof(int8_t));
+			stream.read(reinterpret_cast<char*>(&m_pan), sizeof(int8_t));
+			
+			stream.ignore(1);
+			
+			stream.read(reinterpret_cast<char*>(&m_ampEnvDynRange), sizeof(int8_t));
+			stream.read(reinterpret_cast<char*>(&m_filterType), sizeof(EEOSFilterType));
+			
+			stream.ignore(1);
+
+			uint8_t filterFreq(0ui8);
+			stream.read(reinterpret_cast<char*>(&filterFreq), sizeof(uint8_t));
+
+			m_filterFrequency = unit_helpers::ConvertByteToFilterFrequency(filterFreq);
+			
+			uint8_t filterRes(0ui8);
+			stream.read(reinterpret_cast<char*>(&filterRes), sizeof(uint8_t));
+
+			m_filterResonance = unit_helpers::round_f_places(unit_helpers::ConvertByteToPercentF(filterRes), 1u);
+
+			stream.ignore(48);
+
+			stream.read(reinterpret_cast<char*>(&m_ampEnv), sizeof(E4Envelope));
+
+			stream.ignore(2);
+			
+			stream.read(reinterpret_cast<char*>(&m_filterEnv), sizeof(E4Envelope));
+
+			stream.ignore(2);
+			
+			stream.read(reinterpret_cast<char*>(&m_auxEnv), sizeof(E4Envelope));
+
+			stream.ignore(2);
+
+			m_lfo1.Read(stream);
+
+			stream.ignore(1);
+			
+			m_lfo2.Read(stream);
+
+			stream.read(reinterpret_cast<char*>(&m_lfoLag1), sizeof(uint8_t));
+			
+			stream.ignore(1);
+			
+			stream.read(reinterpret_cast<char*>(&m_lfoLag2), sizeof(uint8_t));
+
+			stream.ignore(20);
+
+			for(auto& cord : m_cords)
+			{
+				cord.Read(stream);
+			}
+
+			return zoneCount;
+		}
+	};
+
+	/**
+	 * \brief Voice kept in its encoded form, 284 bytes plus 22 per zone, instead of decoded into E4Voice's wider types.
+	 * Fields are converted when accessed, and unchanged fields are written back exactly as they were read.
+	 */
+	struct E4CompactVoice final
+	{
+		E4CompactVoice() : E4CompactVoice(E4Voice()) {}
+
+		explicit E4CompactVoice(const E4Voice& voice)
+		{
+			FORMChunk voiceChunk;
+			voice.Write(voiceChunk);
+
+			const Span<const char> voiceData(voiceChunk.GetWrittenData());
+			m_data.assign(voiceData.begin(), voiceData.end());
+		}
+
+		void Write(FORMChunk& presetChunk) const
+		{
+			presetChunk.writeType(m_data.data(), m_data.size());
+		}
+		
+		/**
+		 * \return Whether a whole, consistent voice was read, the voice is left unchanged otherwise
+		 */
+		template<typename Stream>
+		[[nodiscard]] bool Read(Stream& stream)
+		{
+			uint16_t voiceDataSize(0ui16);
+			stream.read(reinterpret_cast<char*>(&voiceDataSize), sizeof(uint16_t));
+			
+			// Every field offset assumes the voice itself is there, followed by whole zones:
+			const size_t swappedVoiceDataSize(byteswap_helpers::byteswap_uint16(voiceDataSize));
+			if(stream.eof() || swappedVoiceDataSize < EOS_E4_VOICE_SIZE || (swappedVoiceDataSize - EOS_E4_VOICE_SIZE) % EOS_E4_ZONE_SIZE != 0) { return false; }
+
+			std::vector<char> data(swappedVoiceDataSize);
+			std::memcpy(data.data(), &voiceDataSize, sizeof(uint16_t));
+			stream.read(std::next(data.data(), sizeof(uint16_t)), static_cast<std::streamsize>(data.size() - sizeof(uint16_t)));
+			if(stream.eof()) { return false; }
+
+			const size_t numZones((swappedVoiceDataSize - EOS_E4_VOICE_SIZE) / EOS_E4_ZONE_SIZE);
+			if(static_cast<uint8_t>(data[ZONE_COUNT_OFFSET]) != numZones) { return false; }
+
+			m_data = std::move(data);
+			return true;
+		}
+
+		/**
+		 * \brief Decodes every field at once, such as to edit many of them.
+		 */
+		[[nodiscard]] E4Voice ToVoice() const
+		{
+			MemoryStream stream(m_data.data(), m_data.size());
+
+			E4Voice voice;
+			voice.Read(stream);
+			return voice;
+		}
+		
+		/**
+		 * \return The encoded voice, as written
+		 */
+		[[nodiscard]] Span<const char> GetData() const { return m_data; }
+		
+		[[nodiscard]] size_t GetWriteSize() const { return m_data.size(); }
+		
+		void SetGroup(const uint8_t group) { SetField(GROUP_OFFSET, std::clamp(group, 0ui8, 31ui8)); }
+		void SetKeyData(const E4SampleZoneNoteData data) { SetField(KEY_DATA_OFFSET, data); }
+		void SetVelData(const E4SampleZoneNoteData data) { SetField(VEL_DATA_OFFSET, data); }
+		void SetRTData(const E4SampleZoneNoteData data) { SetField(RT_DATA_OFFSET, data); }
+		void SetKeyAssignGroup(const EEOSAssignGroup group) { SetField(KEY_ASSIGN_GROUP_OFFSET, group); }
+		void SetKeyDelay(const uint16_t milliseconds) { SetField(KEY_DELAY_OFFSET, byteswap_helpers::byteswap_uint16(std::clamp(milliseconds, 0ui16, 10000ui16))); }
+		void SetSampleOffset(const float offset) { SetField(SAMPLE_OFFSET_OFFSET, static_cast<uint8_t>(unit_helpers::ConvertPercentToByteF(std::clamp(offset, 0.f, 100.f)))); }
+		void SetTranspose(const int8_t cents) { SetField(TRANSPOSE_OFFSET, std::clamp(cents, MIN_TRANSPOSE_BYTE, MAX_TRANSPOSE_BYTE)); }
+		void SetCoarseTune(const int8_t cents) { SetField(COARSE_TUNE_OFFSET, std::clamp(cents, MIN_COARSE_TUNE_BYTE, MAX_COARSE_TUNE_BYTE)); }
+		void SetFineTune(const double fineTune) { SetField(FINE_TUNE_OFFSET, unit_helpers::ConvertFineTuneToByte(std::clamp(fineTune, -100.0, 100.0))); }
+		void SetIsFixedPitch(const bool arg) { SetField(FIXED_PITCH_OFFSET, arg); }
+		void SetKeyMode(const EEOSKeyMode mode) { SetField(KEY_MODE_OFFSET, mode); }
+		void SetChorusWidth(const float percent) { SetField(CHORUS_WIDTH_OFFSET, unit_helpers::ConvertChorusWidthToByte(std::clamp(percent, 0.f, 100.f))); }
+		void SetChorusAmount(const float percent) { SetField(CHORUS_AMOUNT_OFFSET, static_cast<uint8_t>(unit_helpers::ConvertPercentToByteF(std::clamp(percent, 0.f, 100.f)))); }
+		void SetGlideCurveType(const EEOSGlideCurveType type) { SetField(GLIDE_CURVE_TYPE_OFFSET, type); }
+		void SetVolume(const int8_t dB) { SetField(VOLUME_OFFSET, std::clamp(dB, MIN_VOLUME_BYTE, MAX_VOLUME_BYTE)); }
+		void SetPan(const int8_t pan) { SetField(PAN_OFFSET, std::clamp(pan, MIN_PAN_BYTE, MAX_PAN_BYTE)); }
+		void SetFilterType(const EEOSFilterType type) { SetField(FILTER_TYPE_OFFSET, type); }
+		void SetFilterFrequency(const uint16_t hertz) { SetField(FILTER_FREQUENCY_OFFSET, unit_helpers::ConvertFilterFrequencyToByte(std::clamp(hertz, MIN_FILTER_FREQUENCY, MAX_FILTER_FREQUENCY))); }
+		void SetFilterResonance(const float percent) { SetField(FILTER_RESONANCE_OFFSET, static_cast<uint8_t>(unit_helpers::ConvertPercentToByteF(std::clamp(percent, 0.f, 100.f)))); }
+		void SetAmpEnv(const E4Envelope& envelope) { SetField(AMP_ENV_OFFSET, envelope); }
+		void SetFilterEnv(const E4Envelope& envelope) { SetField(FILTER_ENV_OFFSET, envelope); }
+		void SetAuxEnv(const E4Envelope& envelope) { SetField(AUX_ENV_OFFSET, envelope); }
+		void SetLFO1(const E4LFO& lfo) { SetEncoded(LFO1_OFFSET, lfo); }
+		void SetLFO2(const E4LFO& lfo) { SetEncoded(LFO2_OFFSET, lfo); }
+		void SetLFOLag1(const uint8_t lag) { SetField(LFO_LAG1_OFFSET, std::clamp(lag, MIN_LFO_LAG_BYTE, MAX_LFO_LAG_BYTE)); }
+		void SetLFOLag2(const uint8_t lag) { SetField(LFO_LAG2_OFFSET, std::clamp(lag, MIN_LFO_LAG_BYTE, MAX_LFO_LAG_BYTE)); }
+
+		void SetCord(const size_t cordIndex, const E4Cord& cord)
+		{
+			assert(cordIndex < NUM_CORDS);
+			if(cordIndex < NUM_CORDS) { SetEncoded(CORDS_OFFSET + CORD_SIZE * cordIndex, cord); }
+		}
+
+		[[nodiscard]] uint8_t GetGroup() const { return GetField<uint8_t>(GROUP_OFFSET); }
+		[[nodiscard]] E4SampleZoneNoteData GetKeyData() const { return GetField<E4SampleZoneNoteData>(KEY_DATA_OFFSET); }
+		[[nodiscard]] E4SampleZoneNoteData GetVelData() const { return GetField<E4SampleZoneNoteData>(VEL_DATA_OFFSET); }
+		[[nodiscard]] E4SampleZoneNoteData GetRTData() const { return GetField<E4SampleZoneNoteData>(RT_DATA_OFFSET); }
+		[[nodiscard]] EEOSAssignGroup GetKeyAssignGroup() const { return GetField<EEOSAssignGroup>(KEY_ASSIGN_GROUP_OFFSET); }
+		[[nodiscard]] uint16_t GetKeyDelay() const { return byteswap_helpers::byteswap_uint16(GetField<uint16_t>(KEY_DELAY_OFFSET)); }
+		[[nodiscard]] float GetSampleOffset() const { return unit_helpers::ConvertByteToPercentF(GetField<uint8_t>(SAMPLE_OFFSET_OFFSET)); }
+		[[nodiscard]] int8_t GetTranspose() const { return GetField<int8_t>(TRANSPOSE_OFFSET); }
+		[[nodiscard]] int8_t GetCoarseTune() const { return GetField<int8_t>(COARSE_TUNE_OFFSET); }
+		[[nodiscard]] double GetFineTune() const { return unit_helpers::ConvertByteToFineTune(GetField<int8_t>(FINE_TUNE_OFFSET)); }
+		[[nodiscard]] uint8_t GetGlideRate() const { return GetField<uint8_t>(GLIDE_RATE_OFFSET); }
+		[[nodiscard]] bool IsFixedPitch() const { return GetField<bool>(FIXED_PITCH_OFFSET); }
+		[[nodiscard]] EEOSKeyMode GetKeyMode() const { return GetField<EEOSKeyMode>(KEY_MODE_OFFSET); }
+		[[nodiscard]] float GetChorusWidth() const { return unit_helpers::GetChorusWidthPercent(GetField<uint8_t>(CHORUS_WIDTH_OFFSET)); }
+		[[nodiscard]] float GetChorusAmount() const { return unit_helpers::round_f_places(unit_helpers::ConvertByteToPercentF(GetField<uint8_t>(CHORUS_AMOUNT_OFFSET)), 2u); }
+		[[nodiscard]] uint8_t GetChorusInitItd() const { return GetField<uint8_t>(CHORUS_INIT_ITD_OFFSET); }
+		[[nodiscard]] bool IsKeyLatch() const { return GetField<bool>(KEY_LATCH_OFFSET); }
+		[[nodiscard]] EEOSGlideCurveType GetGlideCurveType() const { return GetField<EEOSGlideCurveType>(GLIDE_CURVE_TYPE_OFFSET); }
+		[[nodiscard]] int8_t GetVolume() const { return GetField<int8_t>(VOLUME_OFFSET); }
+		[[nodiscard]] int8_t GetPan() const { return GetField<int8_t>(PAN_OFFSET); }
+		[[nodiscard]] int8_t GetAmpEnvDynRange() const { return GetField<int8_t>(AMP_ENV_DYN_RANGE_OFFSET); }
+		[[nodiscard]] EEOSFilterType GetFilterType() const { return GetField<EEOSFilterType>(FILTER_TYPE_OFFSET); }
+		[[nodiscard]] uint16_t GetFilterFrequency() const { return unit_helpers::ConvertByteToFilterFrequency(GetField<uint8_t>(FILTER_FREQUENCY_OFFSET)); }
+		[[nodiscard]] float GetFilterResonance() const { return unit_helpers::round_f_places(unit_helpers::ConvertByteToPercentF(GetField<uint8_t>(FILTER_RESONANCE_OFFSET)), 1u); }
+		[[nodiscard]] E4Envelope GetAmpEnv() const { return GetField<E4Envelope>(AMP_ENV_OFFSET); }
+		[[nodiscard]] E4Envelope GetFilterEnv() const { return GetField<E4Envelope>(FILTER_ENV_OFFSET); }
+		[[nodiscard]] E4Envelope GetAuxEnv() const { return GetField<E4Envelope>(AUX_ENV_OFFSET); }
+		[[nodiscard]] E4LFO GetLFO1() const { return GetDecoded<E4LFO>(LFO1_OFFSET); }
+		[[nodiscard]] E4LFO GetLFO2() const { return GetDecoded<E4LFO>(LFO2_OFFSET); }
+		[[nodiscard]] uint8_t GetLFOLag1() const { return GetField<uint8_t>(LFO_LAG1_OFFSET); }
+		[[nodiscard]] uint8_t GetLFOLag2() const { return GetField<uint8_t>(LFO_LAG2_OFFSET); }
+
+		[[nodiscard]] E4Cord GetCord(const size_t cordIndex) const
+		{
+			assert(cordIndex < NUM_CORDS);
+			if(cordIndex >= NUM_CORDS) { return E4Cord(); }
+			
+			return GetDecoded<E4Cord>(CORDS_OFFSET + CORD_SIZE * cordIndex);
+		}
+
+		/*
+		 * Zones:
+		 */
+		
+		[[nodiscard]] uint8_t GetNumZones() const { return static_cast<uint8_t>((m_data.size() - EOS_E4_VOICE_SIZE) / EOS_E4_ZONE_SIZE); }
+
+		[[nodiscard]] E4SampleZone GetSampleZone(const uint8_t zoneIndex) const
+		{
+			assert(zoneIndex < GetNumZones());
+			if(zoneIndex >= GetNumZones()) { return E4SampleZone(); }
+			
+			return GetDecoded<E4SampleZone>(GetZoneOffset(zoneIndex));
+		}
+
+		void SetSampleZone(const uint8_t zoneIndex, const E4SampleZone& zone)
+		{
+			assert(zoneIndex < GetNumZones());
+			if(zoneIndex < GetNumZones()) { SetEncoded(GetZoneOffset(zoneIndex), zone); }
+		}
+
+		/**
+		 * \brief Reads only the sample index of a zone, e.g. to find the samples a voice uses.
+		 */
+		[[nodiscard]] uint16_t GetZoneSampleIndex(const uint8_t zoneIndex) const
+		{
+			assert(zoneIndex < GetNumZones());
+			if(zoneIndex >= GetNumZones()) { return 0ui16; }
+			
+			return byteswap_helpers::byteswap_uint16(GetField<uint16_t>(GetZoneOffset(zoneIndex) + ZONE_SAMPLE_INDEX_OFFSET));
+		}
+		
+		void SetZoneSampleIndex(const uint8_t zoneIndex, const uint16_t sampleIndex)
+		{
+			assert(zoneIndex < GetNumZones());
+			if(zoneIndex < GetNumZones())
+			{
+				SetField(GetZoneOffset(zoneIndex) + ZONE_SAMPLE_INDEX_OFFSET, byteswap_helpers::byteswap_uint16(sampleIndex));
+			}
+		}
+
+		void AddSampleZone(const E4SampleZone& zone)
+		{
+			assert(GetNumZones() < std::numeric_limits<uint8_t>::max());
+			if(GetNumZones() >= std::numeric_limits<uint8_t>::max()) { return; }
+
+			m_data.resize(m_data.size() + EOS_E4_ZONE_SIZE);
+			SetEncoded(GetZoneOffset(static_cast<uint8_t>(GetNumZones() - 1u)), zone);
+			
+			UpdateSize();
+		}
+
+		void RemoveSampleZone(const uint8_t zoneIndex)
+		{
+			assert(zoneIndex < GetNumZones());
+			if(zoneIndex >= GetNumZones()) { return; }
+
+			const auto zoneStart(std::next(m_data.begin(), static_cast<ptrdiff_t>(GetZoneOffset(zoneIndex))));
+			m_data.erase(zoneStart, std::next(zoneStart, EOS_E4_ZONE_SIZE));
+			
+			UpdateSize();
+		}
+
+	private:
+		// Offsets within the encoded voice, matching E4Voice::Write:
+		static constexpr size_t ZONE_COUNT_OFFSET = 2;
+		static constexpr size_t GROUP_OFFSET = 3;
+		static constexpr size_t KEY_DATA_OFFSET = 12;
+		static constexpr size_t VEL_DATA_OFFSET = 16;
+		static constexpr size_t RT_DATA_OFFSET = 20;
+		static constexpr size_t KEY_ASSIGN_GROUP_OFFSET = 25;
+		static constexpr size_t KEY_DELAY_OFFSET = 26;
+		static constexpr size_t SAMPLE_OFFSET_OFFSET = 31;
+		static constexpr size_t TRANSPOSE_OFFSET = 32;
+		static constexpr size_t COARSE_TUNE_OFFSET = 33;
+		static constexpr size_t FINE_TUNE_OFFSET = 34;
+		static constexpr size_t GLIDE_RATE_OFFSET = 35;
+		static constexpr size_t FIXED_PITCH_OFFSET = 36;
+		static constexpr size_t KEY_MODE_OFFSET = 37;
+		static constexpr size_t CHORUS_WIDTH_OFFSET = 39;
+		static constexpr size_t CHORUS_AMOUNT_OFFSET = 40;
+		static constexpr size_t CHORUS_INIT_ITD_OFFSET = 42;
+		static constexpr size_t KEY_LATCH_OFFSET = 48;
+		static constexpr size_t GLIDE_CURVE_TYPE_OFFSET = 51;
+		static constexpr size_t VOLUME_OFFSET = 52;
+		static constexpr size_t PAN_OFFSET = 53;
+		static constexpr size_t AMP_ENV_DYN_RANGE_OFFSET = 55;
+		static constexpr size_t FILTER_TYPE_OFFSET = 56;
+		static constexpr size_t FILTER_FREQUENCY_OFFSET = 58;
+		static constexpr size_t FILTER_RESONANCE_OFFSET = 59;
+		static constexpr size_t AMP_ENV_OFFSET = 108;
+		static constexpr size_t FILTER_ENV_OFFSET = 122;
+		static constexpr size_t AUX_ENV_OFFSET = 136;
+		static constexpr size_t LFO1_OFFSET = 150;
+		static constexpr size_t LFO2_OFFSET = 158;
+		static constexpr size_t LFO_LAG1_OFFSET = 165;
+		static constexpr size_t LFO_LAG2_OFFSET = 167;
+		static constexpr size_t CORDS_OFFSET = 188;
+		static constexpr size_t CORD_SIZE = 4;
+		static constexpr size_t NUM_CORDS = 24;
+		static constexpr size_t ZONE_SAMPLE_INDEX_OFFSET = 8; // Within the zone
+
+		static_assert(CORDS_OFFSET + CORD_SIZE * NUM_CORDS == EOS_E4_VOICE_SIZE);
+		
+		[[nodiscard]] static size_t GetZoneOffset(const uint8_t zoneIndex) { return EOS_E4_VOICE_SIZE + EOS_E4_ZONE_SIZE * zoneIndex; }
+		
+		template<typename T>
+		[[nodiscard]] T GetField(const size_t offset) const
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			
+			T value;
+			std::memcpy(&value, std::next(m_data.data(), static_cast<ptrdiff_t>(offset)), sizeof(T));
+			return value;
+		}
+
+		template<typename T>
+		void SetField(const size_t offset, const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			std::memcpy(std::next(m_data.data(), static_cast<ptrdiff_t>(offset)), &value, sizeof(T));
+		}
+
+		// For types which convert when read and written:
+		template<typename T>
+		[[nodiscard]] T GetDecoded(const size_t offset) const
+		{
+			MemoryStream stream(std::next(m_data.data(), static_cast<ptrdiff_t>(offset)), m_data.size() - offset);
+			
+			T value;
+			value.Read(stream);
+			return value;
+		}
+
+		template<typename T>
+		void SetEncoded(const size_t offset, const T& value)
+		{
+			FORMChunk chunk;
+			value.Write(chunk);
+
+			const Span<const char> encoded(chunk.GetWrittenData());
+			assert(offset + encoded.size() <= m_data.size());
+			std::copy(encoded.begin(), encoded.end(), std::next(m_data.begin(), static_cast<ptrdiff_t>(offset)));
+		}
+
+		void UpdateSize()
+		{
+			SetField(0, byteswap_helpers::byteswap_uint16(static_cast<uint16_t>(m_data.size())));
+			SetField(ZONE_COUNT_OFFSET, GetNumZones());
+		}
+		
+		std::vector<char> m_data{};
 	};
 
 	/*
 	 * Presets:
 	 */
 
+	/**
+	 * \brief Fixed size header at the start of every E4P1 chunk, decoded without allocating.
+	 */
+	struct E4PresetHeader final
+	{
+		E4PresetHeader() = default;
+
+		/**
+		 * \return Whether the header is valid
+		 */
+		template<typename Stream>
+		bool Read(Stream& stream)
+		{
+			stream.read(reinterpret_cast<char*>(&m_index), sizeof(uint16_t));
+			m_index = byteswap_helpers::byteswap_uint16(m_index);
+
+			stream.read(m_name.data(), EOS_E4_MAX_NAME_LEN);
+
+			uint16_t unknown(0ui16);
+			stream.read(reinterpret_cast<char*>(&unknown), sizeof(uint16_t));
+			unknown = byteswap_helpers::byteswap_uint16(unknown);
+
+			// Data size is always generally 82, ensure this.
+			if(unknown != 82ui16)
+			{
+				assert(unknown == 82ui16);
+				return false;
+			}
+
+			stream.read(reinterpret_cast<char*>(&m_numVoices), sizeof(uint16_t));
+			m_numVoices = byteswap_helpers::byteswap_uint16(m_numVoices);
+
+			stream.ignore(4);
+
+			stream.read(reinterpret_cast<char*>(&m_transpose), sizeof(int8_t));
+			stream.read(reinterpret_cast<char*>(&m_volume), sizeof(int8_t));
+
+			stream.ignore(28);
+
+			stream.read(reinterpret_cast<char*>(m_initialMIDIControllers.data()), static_cast<std::streamsize>(m_initialMIDIControllers.size()));
+
+			stream.ignore(24);
+
+			return true;
+		}
+
+		[[nodiscard]] std::string_view GetName() const { return m_name.GetView(); }
+
+		uint16_t m_index = 0ui16;
+		E4BName m_name{};
+		uint16_t m_numVoices = 0ui16;
+		int8_t m_transpose = 0i8;
+		int8_t m_volume = 0i8;
+		std::array<uint8_t, 4> m_initialMIDIControllers{};
+	};
+
 	struct E4Preset final
 	{
 		E4Preset() = default;
@@ -1175,12 +1939,13 @@ namespace simple_e4b
 		{
 			SetIndex(index);
 			
-			ApplyEOSNamingStandards(presetName);
-			m_name = std::move(presetName);
+			m_name.Assign(presetName);
 		}
 		
 		void Write(FORMChunk& presetChunk) const
 		{
+			presetChunk.Reserve(GetWriteSize());
+			
 			const uint16_t index(byteswap_helpers::byteswap_uint16(m_index));
 			presetChunk.writeType(reinterpret_cast<const char*>(&index), sizeof(uint16_t));
 			
@@ -1213,42 +1978,20 @@ namespace simple_e4b
 			}
 		}
 		
-		void Read(std::ifstream& stream)
-		{
-			stream.read(reinterpret_cast<char*>(&m_index), sizeof(uint16_t));
-			m_index = byteswap_helpers::byteswap_uint16(m_index);
-
-			m_name.clear();
-			m_name.resize(EOS_E4_MAX_NAME_LEN);
-			stream.read(m_name.data(), EOS_E4_MAX_NAME_LEN);
-
-			uint16_t unknown;
-			stream.read(reinterpret_cast<char*>(&unknown), sizeof(uint16_t));
-			unknown = byteswap_helpers::byteswap_uint16(unknown);
-
-			// Data size is always generally 82, ensure this.
-			if(unknown != 82ui16)
-			{
-				assert(unknown == 82ui16);
-				return;
-			}
-
-			uint16_t numVoices;
-			stream.read(reinterpret_cast<char*>(&numVoices), sizeof(uint16_t));
-			numVoices = byteswap_helpers::byteswap_uint16(numVoices);
-
-			stream.ignore(4);
-
-			stream.read(reinterpret_cast<char*>(&m_transpose), sizeof(int8_t));
-			stream.read(reinterpret_cast<char*>(&m_volume), sizeof(int8_t));
-
-			stream.ignore(28);
-
-			stream.read(reinterpret_cast<char*>(m_initialMIDIControllers.data()), static_cast<std::streamsize>(m_initialMIDIControllers.size()));
+		template<typename Stream>
+		void Read(Stream& stream)
+		{
+			E4PresetHeader header;
+			if(!header.Read(stream)) { return; }
 
-			stream.ignore(24);
+			m_index = header.m_index;
+			m_name = header.m_name;
+			m_transpose = header.m_transpose;
+			m_volume = header.m_volume;
+			m_initialMIDIControllers = header.m_initialMIDIControllers;
 
-			for(uint16_t i(0ui16); i < numVoices; ++i)
+			m_voices.reserve(m_voices.size() + header.m_numVoices);
+			for(uint16_t i(0ui16); i < header.m_numVoices; ++i)
 			{
 				E4Voice voice;
 				voice.Read(stream);
@@ -1281,16 +2024,30 @@ namespace simple_e4b
 
 		void SetName(std::string&& name)
 		{
-			ApplyEOSNamingStandards(name);
-			m_name = std::move(name);
+			m_name.Assign(name);
 		}
 
 		void SetTranspose(const int8_t cents) { m_transpose = std::clamp(cents, MIN_TRANSPOSE_BYTE, MAX_TRANSPOSE_BYTE); }
 		void SetVolume(const int8_t dB) { m_volume = std::clamp(dB, MIN_VOLUME_BYTE, MAX_VOLUME_BYTE); }
 
 		[[nodiscard]] uint16_t GetIndex() const { return m_index; }
-		[[nodiscard]] const std::string& GetName() const { return m_name; }
+		[[nodiscard]] std::string_view GetName() const { return m_name.GetView(); }
+		[[nodiscard]] std::vector<E4Voice>& GetVoices() { return m_voices; }
 		[[nodiscard]] const std::vector<E4Voice>& GetVoices() const { return m_voices; }
+
+		/**
+		 * \return Number of bytes Write will produce, used to size the E4P1 chunk up front
+		 */
+		[[nodiscard]] size_t GetWriteSize() const
+		{
+			size_t writeSize(EOS_E4_PRESET_SIZE);
+			for(const auto& voice : m_voices)
+			{
+				writeSize += voice.GetWriteSize();
+			}
+
+			return writeSize;
+		}
 		
 		/**
 		 * \return Transpose in cents
@@ -1304,7 +2061,7 @@ namespace simple_e4b
 		
 	private:
 		uint16_t m_index = 0ui16; // requires byteswap
-		std::string m_name;
+		E4BName m_name{};
 		int8_t m_transpose = 0i8; // [-12, 12]
 		int8_t m_volume = 0i8; // [-96, 10]
 		std::array<uint8_t, 4> m_initialMIDIControllers{EOS_E4_INITIAL_MIDI_CONTROLLER_OFF, EOS_E4_INITIAL_MIDI_CONTROLLER_OFF,
@@ -1317,6 +2074,124 @@ namespace simple_e4b
 		std::vector<E4Voice> m_voices;
 	};
 
+	/**
+	 * \brief Preset kept as its encoded E4P1 chunk, with voices held as E4CompactVoice, so it stays small and is written back exactly as it was read.
+	 */
+	struct E4CompactPreset final
+	{
+		E4CompactPreset() : E4CompactPreset(E4Preset()) {}
+
+		explicit E4CompactPreset(const E4Preset& preset)
+		{
+			FORMChunk presetChunk;
+			preset.Write(presetChunk);
+
+			const Span<const char> presetData(presetChunk.GetWrittenData());
+			std::copy_n(presetData.begin(), EOS_E4_PRESET_SIZE, m_header.begin());
+
+			m_voices.reserve(preset.GetVoices().size());
+			for(const auto& voice : preset.GetVoices()) { m_voices.emplace_back(voice); }
+		}
+
+		void Write(FORMChunk& presetChunk) const
+		{
+			presetChunk.Reserve(GetWriteSize());
+
+			// The voice count is the only header field which follows the voices, everything else is written as read:
+			std::array<char, EOS_E4_PRESET_SIZE> header(m_header);
+			const uint16_t numVoices(byteswap_helpers::byteswap_uint16(static_cast<uint16_t>(m_voices.size())));
+			std::memcpy(std::next(header.data(), NUM_VOICES_OFFSET), &numVoices, sizeof(uint16_t));
+			
+			presetChunk.writeType(header.data(), header.size());
+
+			for(const auto& voice : m_voices)
+			{
+				voice.Write(presetChunk);
+			}
+		}
+
+		/**
+		 * \return Whether the whole preset was read, the preset is left unchanged otherwise
+		 */
+		template<typename Stream>
+		[[nodiscard]] bool Read(Stream& stream)
+		{
+			std::array<char, EOS_E4_PRESET_SIZE> header{};
+			stream.read(header.data(), static_cast<std::streamsize>(header.size()));
+			if(stream.eof()) { return false; }
+
+			MemoryStream headerStream(header.data(), header.size());
+			E4PresetHeader decodedHeader;
+			if(!decodedHeader.Read(headerStream)) { return false; }
+
+			// Grown as voices are read, so a corrupt voice count can't allocate up front:
+			std::vector<E4CompactVoice> voices;
+			E4CompactVoice voice;
+			for(uint16_t i(0ui16); i < decodedHeader.m_numVoices; ++i)
+			{
+				if(!voice.Read(stream)) { return false; }
+				voices.emplace_back(std::move(voice));
+			}
+
+			m_header = header;
+			m_voices = std::move(voices);
+			return true;
+		}
+
+		/**
+		 * \brief Decodes the whole preset, such as to edit it.
+		 */
+		[[nodiscard]] E4Preset ToPreset() const
+		{
+			FORMChunk presetChunk;
+			Write(presetChunk);
+
+			const Span<const char> presetData(presetChunk.GetWrittenData());
+			MemoryStream stream(presetData.data(), presetData.size());
+
+			E4Preset preset;
+			preset.Read(stream);
+			return preset;
+		}
+
+		void SetIndex(uint16_t index)
+		{
+			// Max indicates that the index will be automatically assigned, as with E4Preset.
+			if(index != std::numeric_limits<uint16_t>::max()) { index = std::clamp(index, 0ui16, static_cast<uint16_t>(EOS_E4_MAX_PRESETS)); }
+
+			const uint16_t swappedIndex(byteswap_helpers::byteswap_uint16(index));
+			std::memcpy(m_header.data(), &swappedIndex, sizeof(uint16_t));
+		}
+
+		[[nodiscard]] uint16_t GetIndex() const
+		{
+			uint16_t index(0ui16);
+			std::memcpy(&index, m_header.data(), sizeof(uint16_t));
+			return byteswap_helpers::byteswap_uint16(index);
+		}
+
+		[[nodiscard]] std::string_view GetName() const { return {std::next(m_header.data(), sizeof(uint16_t)), EOS_E4_MAX_NAME_LEN}; }
+		[[nodiscard]] std::vector<E4CompactVoice>& GetVoices() { return m_voices; }
+		[[nodiscard]] const std::vector<E4CompactVoice>& GetVoices() const { return m_voices; }
+
+		[[nodiscard]] size_t GetWriteSize() const
+		{
+			size_t writeSize(EOS_E4_PRESET_SIZE);
+			for(const auto& voice : m_voices)
+			{
+				writeSize += voice.GetWriteSize();
+			}
+
+			return writeSize;
+		}
+
+	private:
+		static constexpr size_t NUM_VOICES_OFFSET = sizeof(uint16_t) + EOS_E4_MAX_NAME_LEN + sizeof(uint16_t);
+		
+		std::array<char, EOS_E4_PRESET_SIZE> m_header{};
+		std::vector<E4CompactVoice> m_voices{};
+	};
+
 	/*
 	 * Sample
 	 */
@@ -1368,7 +2243,8 @@ namespace simple_e4b
 			SetLoopEnd(loopEnd, numSamples, numChannels);
 		}
 		
-		void Read(std::ifstream& stream)
+		template<typename Stream>
+		void Read(Stream& stream)
 		{
 			stream.read(reinterpret_cast<char*>(&m_unknown), sizeof(uint32_t));
 			stream.read(reinterpret_cast<char*>(&m_sampleStartL), sizeof(uint32_t));
@@ -1436,6 +2312,67 @@ namespace simple_e4b
 		LEFT = 0ui8, MONO = 0ui8, RIGHT
 	};
 
+	struct E3SampleFrame final
+	{
+		int16_t m_left = 0i16;
+		int16_t m_right = 0i16;
+	};
+
+	/**
+	 * \brief Iterates the left and right channels of a sample together, see E3Sample::GetFrames.
+	 */
+	struct E3SampleFrames final
+	{
+		struct Iterator final
+		{
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = E3SampleFrame;
+			using difference_type = ptrdiff_t;
+			using pointer = void;
+			using reference = E3SampleFrame;
+			
+			[[nodiscard]] E3SampleFrame operator*() const { return {*m_left, *m_right}; }
+			
+			Iterator& operator++()
+			{
+				++m_left;
+				++m_right;
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				const Iterator previous(*this);
+				++*this;
+				return previous;
+			}
+
+			[[nodiscard]] bool operator==(const Iterator& other) const { return m_left == other.m_left; }
+			[[nodiscard]] bool operator!=(const Iterator& other) const { return m_left != other.m_left; }
+
+			const int16_t* m_left = nullptr;
+			const int16_t* m_right = nullptr;
+		};
+
+		E3SampleFrames() = default;
+
+		// Uneven channels are walked to the end of the shorter one.
+		explicit E3SampleFrames(const Span<const int16_t> left, const Span<const int16_t> right)
+			: m_left(left.data()), m_right(right.data()), m_numFrames(std::min(left.size(), right.size())) {}
+
+		[[nodiscard]] Iterator begin() const { return {m_left, m_right}; }
+		[[nodiscard]] Iterator end() const { return {std::next(m_left, static_cast<ptrdiff_t>(m_numFrames)), std::next(m_right, static_cast<ptrdiff_t>(m_numFrames))}; }
+		[[nodiscard]] size_t size() const { return m_numFrames; }
+		[[nodiscard]] bool empty() const { return m_numFrames == 0; }
+
+		[[nodiscard]] E3SampleFrame operator[](const size_t frame) const { return {m_left[frame], m_right[frame]}; }
+		
+	private:
+		const int16_t* m_left = nullptr;
+		const int16_t* m_right = nullptr;
+		size_t m_numFrames = 0;
+	};
+
 	struct SampleLoopInfo final
 	{
 		explicit SampleLoopInfo(const bool loop = false, const bool loopInRelease = false, const uint32_t loopStart = 0u, const uint32_t loopEnd = 0u)
@@ -1446,6 +2383,112 @@ namespace simple_e4b
 		uint32_t m_loopStart = 0u;
 		uint32_t m_loopEnd = 0u;
 	};
+
+	/**
+	 * \brief Everything in an E3S1 chunk preceding the sample data, decoded without allocating.
+	 */
+	struct E3SampleHeader final
+	{
+		E3SampleHeader() = default;
+
+		// Size of everything in an E3S1 chunk preceding the sample data.
+		static constexpr size_t SIZE = sizeof(uint16_t) + EOS_E4_MAX_NAME_LEN + sizeof(E3SampleParams)
+			+ sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t) * EOS_NUM_EXTRA_SAMPLE_PARAMETERS;
+
+		template<typename Stream>
+		void Read(Stream& stream, const size_t subChunkSize)
+		{
+			stream.read(reinterpret_cast<char*>(&m_index), sizeof(uint16_t));
+			m_index = byteswap_helpers::byteswap_uint16(m_index);
+
+			stream.read(m_name.data(), EOS_E4_MAX_NAME_LEN);
+			
+			m_params.Read(stream);
+
+			stream.read(reinterpret_cast<char*>(&m_sampleRate), sizeof(uint32_t));
+			stream.read(reinterpret_cast<char*>(&m_format), sizeof(uint32_t));
+			
+			stream.read(reinterpret_cast<char*>(m_extraParams.data()), sizeof(uint32_t) * EOS_NUM_EXTRA_SAMPLE_PARAMETERS);
+
+			assert(subChunkSize >= SIZE);
+			m_numSampleData = subChunkSize >= SIZE ? (subChunkSize - SIZE) / sizeof(int16_t) : 0;
+		}
+
+		[[nodiscard]] std::string_view GetName() const { return m_name.GetView(); }
+		[[nodiscard]] uint32_t GetNumChannels() const { return E3SampleHelpers::GetNumChannels(m_format); }
+		
+		[[nodiscard]] SampleLoopInfo GetLoopInfo() const
+		{
+			return SampleLoopInfo(E3SampleHelpers::IsLooping(m_format), E3SampleHelpers::IsLoopingInRelease(m_format),
+				m_params.GetLoopStartL(), m_params.GetLoopEndL());
+		}
+
+		uint16_t m_index = 0ui16;
+		E4BName m_name{};
+		E3SampleParams m_params;
+		uint32_t m_sampleRate = 0u;
+		uint32_t m_format = 0u;
+		std::array<uint32_t, EOS_NUM_EXTRA_SAMPLE_PARAMETERS> m_extraParams{};
+		size_t m_numSampleData = 0; // Number of int16_t following the header, for all channels
+	};
+
+	/**
+	 * \brief Location of sample data within a bank file, which is only read the first time it is requested.
+	 */
+	struct E3SampleDataSource final
+	{
+		explicit E3SampleDataSource(std::filesystem::path file, const uint64_t offset, const size_t numSampleData)
+			: m_file(std::move(file)), m_offset(offset), m_numSampleData(numSampleData) {}
+
+		[[nodiscard]] const std::vector<int16_t>& GetData()
+		{
+			std::call_once(m_loadFlag, [this]
+			{
+				m_data.resize(m_numSampleData);
+				
+				std::ifstream stream(m_file.c_str(), std::ios::binary);
+				if(stream.is_open())
+				{
+					stream.seekg(static_cast<std::streamoff>(m_offset));
+					stream.read(reinterpret_cast<char*>(m_data.data()), static_cast<std::streamsize>(sizeof(int16_t) * m_data.size()));	
+				}
+
+				// The file may have been moved, replaced or truncated since the bank was read. Missing data is left silent, so the size still holds:
+				if(!stream.is_open() || stream.gcount() != static_cast<std::streamsize>(sizeof(int16_t) * m_data.size()))
+				{
+					std::fill(m_data.begin(), m_data.end(), 0i16);
+					m_loadFailed = true;
+					return;
+				}
+				
+				m_loaded = true;
+			});
+			
+			return m_data;
+		}
+
+		/**
+		 * \return Whether the data was read successfully
+		 */
+		[[nodiscard]] bool IsLoaded() const { return m_loaded; }
+
+		/**
+		 * \return Whether the data couldn't be read from the file, it is then silent and isn't read again
+		 */
+		[[nodiscard]] bool HasLoadFailed() const { return m_loadFailed; }
+		
+		[[nodiscard]] size_t GetSize() const { return m_numSampleData; }
+
+	private:
+		std::filesystem::path m_file;
+		uint64_t m_offset = 0u;
+		size_t m_numSampleData = 0;
+
+		std::once_flag m_loadFlag{};
+		std::atomic<bool> m_loaded = false;
+		std::atomic<bool> m_loadFailed = false;
+		std::vector<int16_t> m_data{};
+	};
 	
 	struct E3Sample final
 	{
@@ -1457,18 +2500,26 @@ namespace simple_e4b
 		{
 			SetIndex(index);
 			
-			ApplyEOSNamingStandards(sampleName);
-			m_name = std::move(sampleName);
+			m_name.Assign(sampleName);
 		}
 
 		void Write(FORMChunk& sampleChunk) const
 		{
-			if(m_sampleData.empty())
+			if(GetRawSize() == 0)
 			{
-				assert(!m_sampleData.empty());
+				assert(GetRawSize() > 0);
 				return;
 			}
 			
+			WriteHeader(sampleChunk);
+			sampleChunk.writeType(GetRawData(), sizeof(uint16_t) * GetRawSize());
+		}
+
+		/**
+		 * \brief Writes everything except the sample data, E3SampleHeader::SIZE bytes.
+		 */
+		void WriteHeader(FORMChunk& sampleChunk) const
+		{
 			const uint16_t index(byteswap_helpers::byteswap_uint16(m_index));
 			sampleChunk.writeType(reinterpret_cast<const char*>(&index), sizeof(uint16_t));
 			
@@ -1485,42 +2536,88 @@ namespace simple_e4b
 			sampleChunk.writeType(&format);
 
 			sampleChunk.writeType(m_extraParams.data(), sizeof(uint32_t) * EOS_NUM_EXTRA_SAMPLE_PARAMETERS);
-			sampleChunk.writeType(m_sampleData.data(), sizeof(uint16_t) * m_sampleData.size());
 		}
 		
-		void Read(std::ifstream& stream, const size_t subChunkSize)
+		template<typename Stream>
+		void Read(Stream& stream, const size_t subChunkSize)
 		{
-			stream.read(reinterpret_cast<char*>(&m_index), sizeof(uint16_t));
-			m_index = byteswap_helpers::byteswap_uint16(m_index);
-
-			m_name.clear();
-			m_name.resize(EOS_E4_MAX_NAME_LEN);
-			stream.read(m_name.data(), EOS_E4_MAX_NAME_LEN);
-			
-			m_params.Read(stream);
+			const size_t numSampleData(ReadHeader(stream, subChunkSize));
 
-			stream.read(reinterpret_cast<char*>(&m_sampleRate), sizeof(uint32_t));
-
-			uint32_t format(0u);
-			stream.read(reinterpret_cast<char*>(&format), sizeof(uint32_t));
+			if constexpr(std::is_same_v<Stream, MemoryStream>)
+			{
+				// View the data in place if the memory is kept alive (mapped files), avoiding the copy entirely.
+				const char* data(stream.GetCurrent());
+				if(stream.GetOwner() != nullptr && stream.GetRemaining() >= sizeof(int16_t) * numSampleData
+					&& reinterpret_cast<uintptr_t>(data) % alignof(int16_t) == 0u)
+				{
+					m_sampleView = reinterpret_cast<const int16_t*>(data);
+					m_sampleViewSize = numSampleData;
+					m_sampleViewOwner = stream.GetOwner();
 
-			m_numChannels = E3SampleHelpers::GetNumChannels(format);
-			m_loopInfo = SampleLoopInfo(E3SampleHelpers::IsLooping(format), E3SampleHelpers::IsLoopingInRelease(format),
-				m_params.GetLoopStartL(), m_params.GetLoopEndL());
+					stream.ignore(static_cast<std::streamsize>(sizeof(int16_t) * numSampleData));
+					return;
+				}
+			}
 			
-			stream.read(reinterpret_cast<char*>(m_extraParams.data()), sizeof(uint32_t) * EOS_NUM_EXTRA_SAMPLE_PARAMETERS);
+			m_sampleData.resize(numSampleData);
+			stream.read(reinterpret_cast<char*>(m_sampleData.data()), static_cast<std::streamsize>(sizeof(int16_t) * m_sampleData.size()));
+		}
 
-			constexpr size_t SAMPLE_INFO_WITHOUT_SIZE(sizeof(uint16_t) + EOS_E4_MAX_NAME_LEN +
-				sizeof(E3SampleParams) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint32_t) * EOS_NUM_EXTRA_SAMPLE_PARAMETERS);
+		/**
+		 * \brief Reads only the sample header, the sample data is read from the file the first time it is accessed.
+		 */
+		template<typename Stream>
+		void ReadDeferred(Stream& stream, const size_t subChunkSize, const std::filesystem::path& file)
+		{
+			const size_t numSampleData(ReadHeader(stream, subChunkSize));
+			
+			m_deferredData = std::make_shared<E3SampleDataSource>(file, static_cast<uint64_t>(stream.tellg()), numSampleData);
+			stream.ignore(static_cast<std::streamsize>(sizeof(int16_t) * numSampleData));
+		}
 
-			m_sampleData.clear();
-			m_sampleData.resize((subChunkSize - SAMPLE_INFO_WITHOUT_SIZE) / sizeof(int16_t));
-			stream.read(reinterpret_cast<char*>(m_sampleData.data()), static_cast<std::streamsize>(sizeof(int16_t) * m_sampleData.size()));
+		/**
+		 * \brief Ensures deferred sample data is read, otherwise does nothing.
+		 */
+		void LoadSampleData() const
+		{
+			if(m_deferredData != nullptr) { static_cast<void>(m_deferredData->GetData()); }
+		}
+		
+		void SetNumChannels(const uint32_t channels)
+		{
+			m_numChannels = std::clamp(channels, 1u, 2u);
+			m_revision = NewRevision();
 		}
 		
-		void SetNumChannels(const uint32_t channels) { m_numChannels = std::clamp(channels, 1u, 2u); }
 		void SetSampleRate(const uint32_t sampleRate) { m_sampleRate = std::clamp(sampleRate, 7000u, 192000u); }
-		void SetSampleData(std::vector<int16_t>&& data) { m_sampleData = std::move(data); }
+		
+		void SetSampleData(std::vector<int16_t>&& data)
+		{
+			ResetSampleData();
+			m_sampleData = std::move(data);
+			m_revision = NewRevision();
+		}
+
+		/**
+		 * \brief Replaces the sample data along with its loop, updating the params which locate both channels and the loop in the data.
+		 */
+		void SetSampleData(std::vector<int16_t>&& data, const SampleLoopInfo& loopInfo)
+		{
+			SetSampleData(std::move(data));
+
+			m_loopInfo = loopInfo;
+			m_params = E3SampleParams(static_cast<uint32_t>(m_sampleData.size()), m_numChannels, loopInfo.m_loopStart, loopInfo.m_loopEnd);
+		}
+
+		/**
+		 * \brief Sets the loop in both the loop info and the params written with the sample, loop points are in samples per channel.
+		 */
+		void SetLoop(const SampleLoopInfo& loopInfo)
+		{
+			m_loopInfo = loopInfo;
+			m_params.SetLoopStart(loopInfo.m_loopStart, static_cast<uint32_t>(GetRawSize()), m_numChannels);
+			m_params.SetLoopEnd(loopInfo.m_loopEnd, static_cast<uint32_t>(GetRawSize()), m_numChannels);
+		}
 
 		void SetIndex(const uint16_t index)
 		{
@@ -1532,31 +2629,82 @@ namespace simple_e4b
 		
 		void SetName(std::string&& name)
 		{
-			ApplyEOSNamingStandards(name);
-			m_name = std::move(name);
+			m_name.Assign(name);
 		}
 
 		[[nodiscard]] uint16_t GetIndex() const { return m_index; }
 		[[nodiscard]] uint32_t GetNumChannels() const { return m_numChannels; }
 		[[nodiscard]] uint32_t GetSampleRate() const { return m_sampleRate; }
-		[[nodiscard]] const std::string& GetName() const { return m_name; }
+		[[nodiscard]] std::string_view GetName() const { return m_name.GetView(); }
 		[[nodiscard]] SampleLoopInfo& GetLoopInfo() { return m_loopInfo; }
 		[[nodiscard]] const SampleLoopInfo& GetLoopInfo() const { return m_loopInfo; }
 
+		/**
+		 * \return Whether the sample data is viewed in place (e.g. in a memory mapped file) rather than owned
+		 */
+		[[nodiscard]] bool IsSampleDataMapped() const { return m_sampleView != nullptr; }
+
+		/**
+		 * \return Whether the sample data is available without reading from the file, false if reading deferred data failed
+		 */
+		[[nodiscard]] bool IsSampleDataLoaded() const { return m_deferredData == nullptr || m_deferredData->IsLoaded(); }
+
+		/**
+		 * \return Whether deferred sample data couldn't be read from its file (such as once it has been moved or changed), the sample is then silent
+		 */
+		[[nodiscard]] bool HasSampleDataLoadFailed() const { return m_deferredData != nullptr && m_deferredData->HasLoadFailed(); }
+
+		/**
+		 * \return The sample data of all channels as stored, without copying
+		 */
+		[[nodiscard]] Span<const int16_t> GetRawSampleData() const { return {GetRawData(), GetRawSize()}; }
+
+		/**
+		 * \return Number of int16 values in the sample data of all channels, without loading deferred data
+		 */
+		[[nodiscard]] size_t GetRawSampleDataSize() const { return GetRawSize(); }
+
+		/**
+		 * \return Number of int16 values in one channel of the sample data, without loading deferred data
+		 */
+		[[nodiscard]] size_t GetChannelDataSize(const ESampleType type) const
+		{
+			const auto [start, end](GetChannelBounds(type, GetRawSize()));
+			return end - start;
+		}
+
+		/**
+		 * \return 0 while the sample data is as it was read from a file, otherwise an id which changes whenever the data or channels are replaced
+		 */
+		[[nodiscard]] uint64_t GetRevision() const { return m_revision; }
+
 		[[nodiscard]] std::vector<int16_t> GetSampleData(const ESampleType type) const
 		{
-			if(type == ESampleType::RIGHT && m_numChannels == 2u)
-			{
-				return std::vector<int16_t>{m_sampleData.begin() + m_params.GetSampleStartR(),
-					m_sampleData.end() - (static_cast<uint32_t>(m_sampleData.size()) - m_params.GetSampleEndR())};
-			}
-			
-			return std::vector<int16_t>{m_sampleData.begin(), m_sampleData.end() - (static_cast<uint32_t>(m_sampleData.size()) - m_params.GetSampleEndL())};
+			const Span<const int16_t> channelData(GetChannelData(type));
+			return std::vector<int16_t>{channelData.begin(), channelData.end()};
+		}
+
+		/**
+		 * \return One channel of the sample data without copying, mono samples return the same data for either channel
+		 */
+		[[nodiscard]] Span<const int16_t> GetChannelData(const ESampleType type) const
+		{
+			const Span<const int16_t> data(GetRawSampleData());
+			const auto [start, end](GetChannelBounds(type, data.size()));
+			return data.subspan(start, end - start);
+		}
+
+		/**
+		 * \return Both channels walked together frame by frame, without copying
+		 */
+		[[nodiscard]] E3SampleFrames GetFrames() const
+		{
+			return E3SampleFrames(GetChannelData(ESampleType::LEFT), GetChannelData(ESampleType::RIGHT));
 		}
 
 	private:
 		uint16_t m_index = std::numeric_limits<uint16_t>::max(); // requires byteswap
-		std::string m_name;
+		E4BName m_name{};
 		std::array<uint32_t, EOS_NUM_EXTRA_SAMPLE_PARAMETERS> m_extraParams{}; // Always seems to be empty
 
 		SampleLoopInfo m_loopInfo;
@@ -1565,8 +2713,83 @@ namespace simple_e4b
 		uint32_t m_numChannels = 0u; // [1, 2]
 		
 		std::vector<int16_t> m_sampleData{};
+
+		// Set instead of m_sampleData when the data is viewed in place, the owner keeps the memory alive.
+		const int16_t* m_sampleView = nullptr;
+		size_t m_sampleViewSize = 0;
+		std::shared_ptr<const void> m_sampleViewOwner{};
+
+		// Set instead of m_sampleData when the data is read on first access, shared between copies of the sample.
+		std::shared_ptr<E3SampleDataSource> m_deferredData{};
 		
 		E3SampleParams m_params;
+
+		uint64_t m_revision = NewRevision();
+
+		[[nodiscard]] static uint64_t NewRevision()
+		{
+			static std::atomic<uint64_t> nextRevision(1u);
+			return nextRevision++;
+		}
+
+		// Where a channel is in the sample data, guarding against params which don't match the data:
+		[[nodiscard]] std::pair<size_t, size_t> GetChannelBounds(const ESampleType type, const size_t dataSize) const
+		{
+			size_t start(0);
+			size_t end(m_params.GetSampleEndL());
+			if(type == ESampleType::RIGHT && m_numChannels == 2u)
+			{
+				start = m_params.GetSampleStartR();
+				end = m_params.GetSampleEndR();
+			}
+
+			end = std::min(end, dataSize);
+			start = std::min(start, end);
+			return {start, end};
+		}
+
+		template<typename Stream>
+		size_t ReadHeader(Stream& stream, const size_t subChunkSize)
+		{
+			E3SampleHeader header;
+			header.Read(stream, subChunkSize);
+
+			m_index = header.m_index;
+			m_name = header.m_name;
+			m_params = header.m_params;
+			m_sampleRate = header.m_sampleRate;
+			m_numChannels = header.GetNumChannels();
+			m_loopInfo = header.GetLoopInfo();
+			m_extraParams = header.m_extraParams;
+
+			ResetSampleData();
+			m_revision = 0u;
+			
+			return header.m_numSampleData;
+		}
+
+		void ResetSampleData()
+		{
+			m_sampleData.clear();
+			m_sampleView = nullptr;
+			m_sampleViewSize = 0;
+			m_sampleViewOwner.reset();
+			m_deferredData.reset();
+		}
+
+		[[nodiscard]] const int16_t* GetRawData() const
+		{
+			if(m_sampleView != nullptr) { return m_sampleView; }
+			if(m_deferredData != nullptr) { return m_deferredData->GetData().data(); }
+			return m_sampleData.data();
+		}
+		
+		[[nodiscard]] size_t GetRawSize() const
+		{
+			if(m_sampleView != nullptr) { return m_sampleViewSize; }
+			if(m_deferredData != nullptr) { return m_deferredData->GetSize(); }
+			return m_sampleData.size();
+		}
 	};
 
 	/*
@@ -1581,8 +2804,7 @@ namespace simple_e4b
 		{
 			SetIndex(index);
 			
-			ApplyEOSNamingStandards(seqName);
-			m_name = std::move(seqName);
+			m_name.Assign(seqName);
 		}
 
 		void Write(FORMChunk& sampleChunk) const
@@ -1601,13 +2823,12 @@ namespace simple_e4b
 			sampleChunk.writeType(m_midiData.data(), m_midiData.size());
 		}
 		
-		void Read(std::ifstream& stream, const size_t subChunkSize)
+		template<typename Stream>
+		void Read(Stream& stream, const size_t subChunkSize)
 		{
 			stream.read(reinterpret_cast<char*>(&m_index), sizeof(uint16_t));
 			m_index = byteswap_helpers::byteswap_uint16(m_index);
 
-			m_name.clear();
-			m_name.resize(EOS_E4_MAX_NAME_LEN);
 			stream.read(m_name.data(), EOS_E4_MAX_NAME_LEN);
 
 			constexpr size_t SEQ_INFO_WITHOUT_SIZE(sizeof(uint16_t) + EOS_E4_MAX_NAME_LEN);
@@ -1629,17 +2850,16 @@ namespace simple_e4b
 		
 		void SetName(std::string&& name)
 		{
-			ApplyEOSNamingStandards(name);
-			m_name = std::move(name);
+			m_name.Assign(name);
 		}
 
 		[[nodiscard]] uint16_t GetIndex() const { return m_index; }
-		[[nodiscard]] const std::string& GetName() const { return m_name; }
+		[[nodiscard]] std::string_view GetName() const { return m_name.GetView(); }
 		[[nodiscard]] const std::vector<char>& GetMIDIData() const { return m_midiData; }
 		
 	private:
 		uint16_t m_index = std::numeric_limits<uint16_t>::max(); // requires byteswap
-		std::string m_name;
+		E4BName m_name{};
 		std::vector<char> m_midiData{};
 	};
 
@@ -1666,8 +2886,7 @@ namespace simple_e4b
 		
 		explicit E4EMSt(std::string&& emstName, const uint16_t currentPreset) : m_currentPreset(currentPreset)
 		{
-			ApplyEOSNamingStandards(emstName);
-			m_name = std::move(emstName);
+			m_name.Assign(emstName);
 		}
 
 		void Write(FORMChunk& emstChunk) const
@@ -1679,7 +2898,8 @@ namespace simple_e4b
 			
 			emstChunk.writeType(null, 4);
 
-			emstChunk.writeType(reinterpret_cast<const char*>(&m_currentPreset), sizeof(uint16_t));
+			const uint16_t currentPreset(byteswap_helpers::byteswap_uint16(m_currentPreset));
+			emstChunk.writeType(reinterpret_cast<const char*>(&currentPreset), sizeof(uint16_t));
 			emstChunk.writeType(reinterpret_cast<const char*>(&m_midiChannels), static_cast<std::streamsize>(sizeof(E4MIDIChannel) * m_midiChannels.size()));
 
 			emstChunk.writeType(null, 5);
@@ -1689,12 +2909,11 @@ namespace simple_e4b
 			emstChunk.writeType(null, 312);
 		}
 		
-		void Read(std::ifstream& stream)
+		template<typename Stream>
+		void Read(Stream& stream)
 		{
 			stream.ignore(2);
 
-			m_name.clear();
-			m_name.resize(EOS_E4_MAX_NAME_LEN);
 			stream.read(m_name.data(), EOS_E4_MAX_NAME_LEN);
 
 			stream.ignore(4);
@@ -1716,17 +2935,16 @@ namespace simple_e4b
 
 		void SetName(std::string&& name)
 		{
-			ApplyEOSNamingStandards(name);
-			m_name = std::move(name);
+			m_name.Assign(name);
 		}
 
-		[[nodiscard]] const std::string& GetName() const { return m_name; }
+		[[nodiscard]] std::string_view GetName() const { return m_name.GetView(); }
 		[[nodiscard]] uint16_t GetCurrentPreset() const { return m_currentPreset; }
 		[[nodiscard]] const std::array<E4MIDIChannel, 32>& GetMIDIChannels() const { return m_midiChannels; }
 		[[nodiscard]] uint8_t GetTempo() const { return m_tempo; }
 
 	private:
-		std::string m_name;
+		E4BName m_name{};
 		uint16_t m_currentPreset = 0ui16;
 		std::array<E4MIDIChannel, 32> m_midiChannels{};
 		uint8_t m_tempo = 20ui8; // [20, 240]
@@ -0,0 +1,453 @@
+#pragma once
+#include "e4b_dsp.hpp"
+
+namespace simple_e4b
+{
+	/**
+	 * \brief Minimum, maximum and RMS of a range of samples.
+	 */
+	struct E4WaveformPeak final
+	{
+		int16_t m_min = 0i16;
+		int16_t m_max = 0i16;
+		uint16_t m_rms = 0ui16;
+	};
+
+	/**
+	 * \brief Min/max/RMS pyramid of each channel of a sample, so waveforms can be drawn at any zoom without reading the sample data.
+	 * Level 0 has a peak per BASE_BUCKET_SIZE samples, and each level above halves the one below.
+	 */
+	struct E4WaveformOverview final
+	{
+		static constexpr size_t BASE_BUCKET_SIZE = 64;
+
+		E4WaveformOverview() = default;
+		explicit E4WaveformOverview(const E3Sample& sample) { Build(sample); }
+
+		void Build(const E3Sample& sample)
+		{
+			m_numChannels = sample.GetNumChannels() == 2u ? 2u : 1u;
+			m_numSamples = sample.GetChannelData(ESampleType::LEFT).size();
+
+			for(uint32_t channel(0u); channel < m_numChannels; ++channel)
+			{
+				const Span<const int16_t> channelData(sample.GetChannelData(channel == 0u ? ESampleType::LEFT : ESampleType::RIGHT));
+				const size_t numSamples(std::min(channelData.size(), m_numSamples));
+
+				// Both channels get the same buckets, a short right channel is treated as silent past its end:
+				std::vector<E4WaveformPeak>& peaks(m_peaks[channel]);
+				peaks.resize((m_numSamples + BASE_BUCKET_SIZE - 1u) / BASE_BUCKET_SIZE);
+				for(size_t bucket(0); bucket < peaks.size(); ++bucket)
+				{
+					const size_t start(std::min(bucket * BASE_BUCKET_SIZE, numSamples));
+					peaks[bucket] = ScanPeak(channelData.subspan(start, std::min(BASE_BUCKET_SIZE, numSamples - start)));
+				}
+			}
+
+			if(m_numChannels == 1u) { m_peaks[1].clear(); }
+
+			BuildLevels();
+		}
+
+		[[nodiscard]] bool IsEmpty() const { return m_numSamples == 0; }
+		[[nodiscard]] uint32_t GetNumChannels() const { return m_numChannels; }
+
+		/**
+		 * \return Number of samples per channel
+		 */
+		[[nodiscard]] size_t GetNumSamples() const { return m_numSamples; }
+		[[nodiscard]] size_t GetNumLevels() const { return m_levelOffsets.size(); }
+		[[nodiscard]] static size_t GetBucketSize(const size_t level) { return BASE_BUCKET_SIZE << level; }
+
+		[[nodiscard]] Span<const E4WaveformPeak> GetLevel(const ESampleType type, const size_t level) const
+		{
+			if(level >= m_levelOffsets.size()) { return {}; }
+
+			const std::vector<E4WaveformPeak>& peaks(GetChannelPeaks(type));
+			const size_t end(level + 1u < m_levelOffsets.size() ? m_levelOffsets[level + 1u] : peaks.size());
+			return {std::next(peaks.data(), static_cast<ptrdiff_t>(m_levelOffsets[level])), end - m_levelOffsets[level]};
+		}
+
+		/**
+		 * \brief Fills one peak per pixel spread evenly over the samples [start, end), from the coarsest level with buckets no larger than a pixel.
+		 * Pixels narrower than BASE_BUCKET_SIZE samples get the level 0 bucket they fall in, at that zoom the samples are few enough to draw directly.
+		 */
+		void GetPeaks(const ESampleType type, size_t start, size_t end, const Span<E4WaveformPeak> pixels) const
+		{
+			end = std::min(end, m_numSamples);
+			if(pixels.empty() || start >= end || m_levelOffsets.empty())
+			{
+				std::fill(pixels.begin(), pixels.end(), E4WaveformPeak());
+				return;
+			}
+
+			const size_t samplesPerPixel((end - start) / pixels.size());
+
+			size_t level(0);
+			while(level + 1u < m_levelOffsets.size() && GetBucketSize(level + 1u) <= samplesPerPixel) { ++level; }
+
+			const Span<const E4WaveformPeak> peaks(GetLevel(type, level));
+			const size_t bucketSize(GetBucketSize(level));
+			for(size_t pixel(0); pixel < pixels.size(); ++pixel)
+			{
+				const size_t pixelStart(start + (end - start) * pixel / pixels.size());
+				const size_t pixelEnd(std::max(start + (end - start) * (pixel + 1u) / pixels.size(), pixelStart + 1u));
+
+				const size_t firstBucket(pixelStart / bucketSize);
+				const size_t lastBucket(std::min((pixelEnd + bucketSize - 1u) / bucketSize, peaks.size()));
+
+				// Each pixel spans fewer than three buckets, keeping this O(pixels):
+				PeakAccumulator accumulator;
+				for(size_t bucket(firstBucket); bucket < lastBucket; ++bucket)
+				{
+					accumulator.Add(peaks[bucket], GetBucketCount(level, bucket));
+				}
+
+				pixels[pixel] = accumulator.Get();
+			}
+		}
+
+		/**
+		 * \brief Writes level 0 of each channel, the levels above are rebuilt when read.
+		 */
+		void Write(std::ostream& stream) const
+		{
+			const uint32_t numChannels(m_numChannels);
+			const uint64_t numSamples(m_numSamples);
+			stream.write(reinterpret_cast<const char*>(&numChannels), sizeof(uint32_t));
+			stream.write(reinterpret_cast<const char*>(&numSamples), sizeof(uint64_t));
+
+			for(uint32_t channel(0u); channel < m_numChannels; ++channel)
+			{
+				const Span<const E4WaveformPeak> peaks(GetLevel(channel == 0u ? ESampleType::LEFT : ESampleType::RIGHT, 0));
+				stream.write(reinterpret_cast<const char*>(peaks.data()), static_cast<std::streamsize>(sizeof(E4WaveformPeak) * peaks.size()));
+			}
+		}
+
+		[[nodiscard]] bool Read(std::istream& stream)
+		{
+			uint32_t numChannels(0u);
+			uint64_t numSamples(0u);
+			stream.read(reinterpret_cast<char*>(&numChannels), sizeof(uint32_t));
+			stream.read(reinterpret_cast<char*>(&numSamples), sizeof(uint64_t));
+			if(!stream || numChannels < 1u || numChannels > 2u || numSamples > std::numeric_limits<uint32_t>::max()) { return false; }
+
+			// Checked against what is left of the stream before allocating, so a corrupt or truncated sidecar can't ask for more:
+			const uint64_t numBaseBuckets((numSamples + BASE_BUCKET_SIZE - 1u) / BASE_BUCKET_SIZE);
+			if(numBaseBuckets * numChannels * sizeof(E4WaveformPeak) > GetRemaining(stream)) { return false; }
+
+			m_numChannels = numChannels;
+			m_numSamples = static_cast<size_t>(numSamples);
+
+			for(uint32_t channel(0u); channel < m_numChannels; ++channel)
+			{
+				std::vector<E4WaveformPeak>& peaks(m_peaks[channel]);
+				peaks.resize((m_numSamples + BASE_BUCKET_SIZE - 1u) / BASE_BUCKET_SIZE);
+				stream.read(reinterpret_cast<char*>(peaks.data()), static_cast<std::streamsize>(sizeof(E4WaveformPeak) * peaks.size()));
+			}
+
+			if(m_numChannels == 1u) { m_peaks[1].clear(); }
+
+			if(!stream)
+			{
+				*this = E4WaveformOverview();
+				return false;
+			}
+
+			BuildLevels();
+			return true;
+		}
+
+	private:
+		// Combines peaks, weighting RMS by the number of samples each covers:
+		struct PeakAccumulator final
+		{
+			void Add(const E4WaveformPeak& peak, const size_t count)
+			{
+				m_min = std::min(m_min, peak.m_min);
+				m_max = std::max(m_max, peak.m_max);
+				m_sumSquares += static_cast<double>(peak.m_rms) * static_cast<double>(peak.m_rms) * static_cast<double>(count);
+				m_count += count;
+			}
+
+			[[nodiscard]] E4WaveformPeak Get() const
+			{
+				if(m_count == 0) { return {}; }
+				return {m_min, m_max, ToRMS(m_sumSquares, m_count)};
+			}
+
+			int16_t m_min = std::numeric_limits<int16_t>::max();
+			int16_t m_max = std::numeric_limits<int16_t>::min();
+			double m_sumSquares = 0.;
+			size_t m_count = 0;
+		};
+
+		// Bytes from the read position to the end of the stream, 0 if the stream can't seek:
+		[[nodiscard]] static uint64_t GetRemaining(std::istream& stream)
+		{
+			const std::streampos position(stream.tellg());
+			if(position == std::streampos(-1)) { return 0u; }
+
+			stream.seekg(0, std::ios::end);
+			const std::streampos end(stream.tellg());
+			stream.seekg(position);
+			
+			return end > position ? static_cast<uint64_t>(end - position) : 0u;
+		}
+
+		[[nodiscard]] static uint16_t ToRMS(const double sumSquares, const size_t count)
+		{
+			return static_cast<uint16_t>(std::min(std::sqrt(sumSquares / static_cast<double>(count)) + 0.5, static_cast<double>(std::numeric_limits<uint16_t>::max())));
+		}
+
+		[[nodiscard]] static E4WaveformPeak ScanPeak(const Span<const int16_t> samples)
+		{
+			const int16_t* values(samples.data());
+
+			int16_t minimum(std::numeric_limits<int16_t>::max());
+			int16_t maximum(std::numeric_limits<int16_t>::min());
+			uint64_t sumSquares(0u);
+
+			size_t i(0);
+#ifdef SIMPLE_E4B_SSE2
+			if(samples.size() >= 8)
+			{
+				__m128i minimum8(_mm_set1_epi16(std::numeric_limits<int16_t>::max()));
+				__m128i maximum8(_mm_set1_epi16(std::numeric_limits<int16_t>::min()));
+				__m128i sumSquares2(_mm_setzero_si128());
+				const __m128i zero(_mm_setzero_si128());
+				for(; i + 8 <= samples.size(); i += 8)
+				{
+					const __m128i loaded(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+					minimum8 = _mm_min_epi16(minimum8, loaded);
+					maximum8 = _mm_max_epi16(maximum8, loaded);
+
+					// Pairs of squares only fit in 32 bits unsigned, so are widened to 64 bits before accumulating:
+					const __m128i squares(_mm_madd_epi16(loaded, loaded));
+					sumSquares2 = _mm_add_epi64(sumSquares2, _mm_unpacklo_epi32(squares, zero));
+					sumSquares2 = _mm_add_epi64(sumSquares2, _mm_unpackhi_epi32(squares, zero));
+				}
+
+				// Reduce across the lanes:
+				minimum8 = _mm_min_epi16(minimum8, _mm_shuffle_epi32(minimum8, 0x4E));
+				minimum8 = _mm_min_epi16(minimum8, _mm_shuffle_epi32(minimum8, 0xB1));
+				minimum8 = _mm_min_epi16(minimum8, _mm_shufflelo_epi16(minimum8, 0xB1));
+				maximum8 = _mm_max_epi16(maximum8, _mm_shuffle_epi32(maximum8, 0x4E));
+				maximum8 = _mm_max_epi16(maximum8, _mm_shuffle_epi32(maximum8, 0xB1));
+				maximum8 = _mm_max_epi16(maximum8, _mm_shufflelo_epi16(maximum8, 0xB1));
+				sumSquares2 = _mm_add_epi64(sumSquares2, _mm_unpackhi_epi64(sumSquares2, sumSquares2));
+
+				minimum = static_cast<int16_t>(_mm_cvtsi128_si32(minimum8));
+				maximum = static_cast<int16_t>(_mm_cvtsi128_si32(maximum8));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(&sumSquares), sumSquares2);
+			}
+#endif
+			for(; i < samples.size(); ++i)
+			{
+				minimum = std::min(minimum, values[i]);
+				maximum = std::max(maximum, values[i]);
+				sumSquares += static_cast<uint64_t>(static_cast<int32_t>(values[i]) * static_cast<int32_t>(values[i]));
+			}
+
+			if(samples.empty()) { return {}; }
+			return {minimum, maximum, ToRMS(static_cast<double>(sumSquares), samples.size())};
+		}
+
+		[[nodiscard]] const std::vector<E4WaveformPeak>& GetChannelPeaks(const ESampleType type) const
+		{
+			return type == ESampleType::RIGHT && m_numChannels == 2u ? m_peaks[1] : m_peaks[0];
+		}
+
+		// Samples in a bucket, only the last bucket of a level can be partial:
+		[[nodiscard]] size_t GetBucketCount(const size_t level, const size_t bucket) const
+		{
+			const size_t bucketSize(GetBucketSize(level));
+			return std::min(bucketSize, m_numSamples - std::min(bucket * bucketSize, m_numSamples));
+		}
+
+		// Appends each level above level 0 by merging pairs, until a level has a single peak:
+		void BuildLevels()
+		{
+			const size_t numBaseBuckets(m_peaks[0].size());
+
+			m_levelOffsets.clear();
+			if(numBaseBuckets == 0) { return; }
+
+			m_levelOffsets.emplace_back(0);
+			for(size_t numBuckets(numBaseBuckets), offset(0); numBuckets > 1u; numBuckets = (numBuckets + 1u) / 2u)
+			{
+				const size_t level(m_levelOffsets.size() - 1u);
+				const size_t nextOffset(offset + numBuckets);
+
+				for(uint32_t channel(0u); channel < m_numChannels; ++channel)
+				{
+					std::vector<E4WaveformPeak>& peaks(m_peaks[channel]);
+					peaks.resize(nextOffset + (numBuckets + 1u) / 2u);
+					for(size_t bucket(0); bucket < numBuckets; bucket += 2u)
+					{
+						PeakAccumulator accumulator;
+						accumulator.Add(peaks[offset + bucket], GetBucketCount(level, bucket));
+						if(bucket + 1u < numBuckets) { accumulator.Add(peaks[offset + bucket + 1u], GetBucketCount(level, bucket + 1u)); }
+
+						peaks[nextOffset + bucket / 2u] = accumulator.Get();
+					}
+				}
+
+				m_levelOffsets.emplace_back(nextOffset);
+				offset = nextOffset;
+			}
+		}
+
+		uint32_t m_numChannels = 0u;
+		size_t m_numSamples = 0;
+		std::array<std::vector<E4WaveformPeak>, 2> m_peaks{}; // Every level of each channel, level 0 first
+		std::vector<size_t> m_levelOffsets{}; // First peak of each level, the same for both channels
+	};
+
+	/**
+	 * \brief Waveform overviews of a bank's samples by sample index, kept in a sidecar file next to the bank (bank.E4B.e4w).
+	 * The sidecar is ignored if the bank file has changed since it was saved, and an overview is rebuilt if its sample's data has changed since it was built.
+	 * Only overviews of sample data as it was read from the bank file are saved, those of edited samples are rebuilt once the bank is written and read again.
+	 */
+	struct E4WaveformCache final
+	{
+		explicit E4WaveformCache(std::filesystem::path bankFile) : m_bankFile(std::move(bankFile)), m_overviews(EOS_E4_MAX_SAMPLES + 1) {}
+
+		[[nodiscard]] std::filesystem::path GetSidecarPath() const
+		{
+			std::filesystem::path sidecarPath(m_bankFile);
+			sidecarPath += ".e4w";
+			return sidecarPath;
+		}
+
+		/**
+		 * \return The sample's overview, built from the sample data only when it isn't cached
+		 */
+		[[nodiscard]] const E4WaveformOverview& Get(const E3Sample& sample)
+		{
+			assert(sample.GetIndex() <= EOS_E4_MAX_SAMPLES);
+
+			// Checked without touching the sample data, so deferred data is only read when the overview is built:
+			Entry& entry(m_overviews[std::min(static_cast<size_t>(sample.GetIndex()), EOS_E4_MAX_SAMPLES)]);
+			if(entry.m_overview.IsEmpty() || entry.m_revision != sample.GetRevision() || entry.m_overview.GetNumChannels() != std::clamp(sample.GetNumChannels(), 1u, 2u)
+				|| entry.m_overview.GetNumSamples() != sample.GetChannelDataSize(ESampleType::LEFT))
+			{
+				entry.m_overview.Build(sample);
+				entry.m_revision = sample.GetRevision();
+				m_isModified = true;
+			}
+
+			return entry.m_overview;
+		}
+
+		/**
+		 * \brief Drops the overview of the sample at index, such as once it has been replaced.
+		 */
+		void Invalidate(const uint16_t index)
+		{
+			assert(index <= EOS_E4_MAX_SAMPLES);
+			if(index > EOS_E4_MAX_SAMPLES) { return; }
+
+			m_overviews[index] = Entry();
+			m_isModified = true;
+		}
+
+		void Clear()
+		{
+			std::fill(m_overviews.begin(), m_overviews.end(), Entry());
+			m_isModified = true;
+		}
+
+		/**
+		 * \return Whether the sidecar existed and matched the bank file
+		 */
+		bool Load()
+		{
+			std::ifstream stream(GetSidecarPath().c_str(), std::ios::binary);
+			if(!stream.is_open()) { return false; }
+
+			std::array<char, 4> magic{};
+			uint64_t bankStamp(0u);
+			uint32_t numOverviews(0u);
+			stream.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+			stream.read(reinterpret_cast<char*>(&bankStamp), sizeof(uint64_t));
+			stream.read(reinterpret_cast<char*>(&numOverviews), sizeof(uint32_t));
+			if(!stream || std::string_view{magic.data(), magic.size()} != SIDECAR_MAGIC || bankStamp != GetBankStamp()) { return false; }
+
+			for(uint32_t i(0u); i < numOverviews; ++i)
+			{
+				uint16_t index(0ui16);
+				stream.read(reinterpret_cast<char*>(&index), sizeof(uint16_t));
+
+				E4WaveformOverview overview;
+				if(!stream || index > EOS_E4_MAX_SAMPLES || !overview.Read(stream)) { return false; }
+
+				// Saved overviews are all of sample data as read from the bank file:
+				m_overviews[index] = {std::move(overview), 0u};
+			}
+
+			m_isModified = false;
+			return true;
+		}
+
+		/**
+		 * \brief Writes the sidecar if any overview was built since it was loaded or saved.
+		 */
+		bool Save()
+		{
+			if(!m_isModified) { return true; }
+
+			std::ofstream stream(GetSidecarPath().c_str(), std::ios::binary);
+			if(!stream.is_open()) { return false; }
+
+			const uint64_t bankStamp(GetBankStamp());
+			const uint32_t numOverviews(static_cast<uint32_t>(std::count_if(m_overviews.begin(), m_overviews.end(),
+				[](const Entry& entry) { return entry.IsSaved(); })));
+
+			stream.write(SIDECAR_MAGIC.data(), static_cast<std::streamsize>(SIDECAR_MAGIC.size()));
+			stream.write(reinterpret_cast<const char*>(&bankStamp), sizeof(uint64_t));
+			stream.write(reinterpret_cast<const char*>(&numOverviews), sizeof(uint32_t));
+
+			for(size_t index(0); index < m_overviews.size(); ++index)
+			{
+				if(!m_overviews[index].IsSaved()) { continue; }
+
+				const uint16_t sampleIndex(static_cast<uint16_t>(index));
+				stream.write(reinterpret_cast<const char*>(&sampleIndex), sizeof(uint16_t));
+				m_overviews[index].m_overview.Write(stream);
+			}
+
+			m_isModified = !stream.good();
+			return stream.good();
+		}
+
+	private:
+		static constexpr std::string_view SIDECAR_MAGIC = "E4W1";
+
+		struct Entry final
+		{
+			// The bank file stamp only describes sample data which hasn't been edited since it was read:
+			[[nodiscard]] bool IsSaved() const { return !m_overview.IsEmpty() && m_revision == 0u; }
+			
+			E4WaveformOverview m_overview{};
+			uint64_t m_revision = 0u; // E3Sample::GetRevision of the sample the overview was built from
+		};
+
+		// Identifies the version of the bank file the overviews were built from, by its size and modification time:
+		[[nodiscard]] uint64_t GetBankStamp() const
+		{
+			std::error_code error;
+			const uint64_t fileSize(std::filesystem::file_size(m_bankFile, error));
+			if(error) { return 0u; }
+
+			const auto writeTime(std::filesystem::last_write_time(m_bankFile, error));
+			if(error) { return 0u; }
+
+			return fileSize ^ (static_cast<uint64_t>(writeTime.time_since_epoch().count()) * 0x9E37'79B9'7F4A'7C15u);
+		}
+
+		std::filesystem::path m_bankFile{};
+		std::vector<Entry> m_overviews{}; // By sample index
+		bool m_isModified = false;
+	};
+}
\ No newline at end of file
@@ -1,94 +1,203 @@
 #pragma once
+#include <exception>
 #include <filesystem>
 #include "e4b_types.hpp"
 #include <iostream>
+#include <thread>
+#include <variant>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 namespace simple_e4b
 {
+	/**
+	 * \brief Maps indices from before E4BBank::RemoveBatch or E4BBank::RemoveUnusedSamples to after it.
+	 */
+	struct E4BIndexRemap final
+	{
+		static constexpr uint16_t REMOVED = std::numeric_limits<uint16_t>::max();
+
+		[[nodiscard]] uint16_t GetPreset(const uint16_t oldIndex) const { return Map(m_presets, oldIndex); }
+		[[nodiscard]] uint16_t GetSample(const uint16_t oldIndex) const { return Map(m_samples, oldIndex); }
+		[[nodiscard]] uint16_t GetSequence(const uint16_t oldIndex) const { return Map(m_sequences, oldIndex); }
+
+		// Indexed by the old index, REMOVED if nothing has that index afterwards. Empty if no index was changed.
+		std::vector<uint16_t> m_presets{};
+		std::vector<uint16_t> m_samples{};
+		std::vector<uint16_t> m_sequences{};
+
+		// Whether indices were renumbered. Old indices past the end of a remap are then REMOVED, otherwise they are kept.
+		bool m_isCompacted = false;
+
+	private:
+		[[nodiscard]] uint16_t Map(const std::vector<uint16_t>& remap, const uint16_t oldIndex) const
+		{
+			if(remap.empty()) { return oldIndex; }
+			if(oldIndex < remap.size()) { return remap[oldIndex]; }
+			return m_isCompacted ? REMOVED : oldIndex;
+		}
+	};
+	
+	/**
+	 * \brief Location of a zone using a sample.
+	 */
+	struct E4BSampleUse final
+	{
+		uint16_t m_preset = 0ui16; // Preset index
+		uint16_t m_voice = 0ui16; // Position in the preset's voices
+		uint8_t m_zone = 0ui8; // Position in the voice's zones
+	};
+	
+	struct E4BCompactResult final
+	{
+		E4BIndexRemap m_remap{};
+		size_t m_numSamplesRemoved = 0;
+		size_t m_bytesReclaimed = 0; // From the written .E4B file
+	};
+	
 	struct E4BBank final
 	{
 		E4BBank() = default;
 
 		void AddPreset(E4Preset&& preset)
 		{
-			assert(m_presets.size() < EOS_E4_MAX_PRESETS);
-			if(m_presets.size() >= EOS_E4_MAX_PRESETS) { return; }
-			
-			for(const auto& existingPreset : m_presets)
-			{
-				if(existingPreset->GetIndex() == preset.GetIndex())
-				{
-					assert(existingPreset->GetIndex() != preset.GetIndex());
-					return;
-				}
-			}
-
-			if(preset.GetIndex() == std::numeric_limits<uint16_t>::max())
+			if(const E4Preset* addedPreset = AddIfValid(m_presets, m_presetTable, std::move(preset), EOS_E4_MAX_PRESETS))
 			{
-				preset.SetIndex(static_cast<uint16_t>(m_presets.size()));	
+				AddSampleUses(*addedPreset);
 			}
-
-			m_presets.emplace_back(std::make_shared<E4Preset>(std::move(preset)));
 		}
 
 		void RemovePreset(const uint16_t presetIndex)
 		{
-			RemoveIfValid(m_presets, presetIndex);
+			if(const auto preset = GetPreset(presetIndex).lock()) { RemoveSampleUses(*preset); }
+			RemoveIfValid(m_presets, m_presetTable, presetIndex);
 		}
 
-		void AddSequence(E4Sequence&& sequence)
+		/**
+		 * \brief Adds a zone to a voice of a preset in the bank, keeping the sample uses up to date.
+		 */
+		void AddSampleZone(const uint16_t presetIndex, const uint16_t voiceIndex, E4SampleZone&& zone)
 		{
-			assert(m_sequences.size() < EOS_E4_MAX_SEQUENCES);
-			if(m_sequences.size() >= EOS_E4_MAX_SEQUENCES) { return; }
-			
-			for(const auto& existingSequence : m_sequences)
-			{
-				if(existingSequence->GetIndex() == sequence.GetIndex())
-				{
-					assert(existingSequence->GetIndex() != sequence.GetIndex());
-					return;
-				}
-			}
+			const auto preset(GetPreset(presetIndex).lock());
+			const bool isValidVoice(preset != nullptr && voiceIndex < preset->GetVoices().size());
+			assert(isValidVoice);
+			if(!isValidVoice) { return; }
 
-			if(sequence.GetIndex() == std::numeric_limits<uint16_t>::max())
+			auto& voice(preset->GetVoices()[voiceIndex]);
+			const size_t numZones(voice.GetSampleZones().size());
+			const uint16_t sampleIndex(zone.GetSampleIndex());
+			
+			voice.AddSampleZone(std::move(zone));
+			if(voice.GetSampleZones().size() > numZones)
 			{
-				sequence.SetIndex(static_cast<uint16_t>(m_sequences.size()));	
+				AddSampleUse(sampleIndex, {presetIndex, voiceIndex, static_cast<uint8_t>(numZones)});
 			}
+		}
 
-			m_sequences.emplace_back(std::make_shared<E4Sequence>(std::move(sequence)));
+		void AddSequence(E4Sequence&& sequence)
+		{
+			AddIfValid(m_sequences, m_sequenceTable, std::move(sequence), EOS_E4_MAX_SEQUENCES);
 		}
 
 		void RemoveSequence(const uint16_t sequenceIndex)
 		{
-			RemoveIfValid(m_sequences, sequenceIndex);
+			RemoveIfValid(m_sequences, m_sequenceTable, sequenceIndex);
 		}
 		
 		void AddSample(E3Sample&& sample)
 		{
-			assert(m_samples.size() < EOS_E4_MAX_SAMPLES);
-			if(m_samples.size() >= EOS_E4_MAX_SAMPLES) { return; }
+			AddIfValid(m_samples, m_sampleTable, std::move(sample), EOS_E4_MAX_SAMPLES);
+		}
+
+		void RemoveSample(const uint16_t sampleIndex)
+		{
+			RemoveIfValid(m_samples, m_sampleTable, sampleIndex);
+		}
+		
+		/**
+		 * \brief Removes every listed preset, sample and sequence in one pass over each vector, optionally renumbering what remains densely in index order.
+		 * Zone sample indices and the startup preset are rewritten to match. Zones using a removed sample are removed,
+		 * and when compacting, so are zones using a sample that didn't exist. An index may be listed more than once.
+		 * \return How every index was changed
+		 */
+		E4BIndexRemap RemoveBatch(const Span<const uint16_t> presetIndices, const Span<const uint16_t> sampleIndices,
+			const Span<const uint16_t> sequenceIndices, const bool compactIndices = false)
+		{
+			E4BIndexRemap remap;
+			remap.m_isCompacted = compactIndices;
+			remap.m_presets = RemoveBatchFrom(m_presets, m_presetTable, presetIndices, compactIndices);
+			remap.m_samples = RemoveBatchFrom(m_samples, m_sampleTable, sampleIndices, compactIndices);
+			remap.m_sequences = RemoveBatchFrom(m_sequences, m_sequenceTable, sequenceIndices, compactIndices);
+
+			ApplyRemap(remap);
+			return remap;
+		}
+
+		/**
+		 * \brief Removes every sample no zone uses and renumbers the remaining samples densely, rewriting zone sample indices to match.
+		 * Zones using a sample that doesn't exist are removed too. Linear in the number of zones, the sample uses are rebuilt first in case zones were changed directly.
+		 */
+		E4BCompactResult RemoveUnusedSamples()
+		{
+			RebuildSampleUses();
+
+			E4BCompactResult result;
 			
-			for(const auto& existingSample : m_samples)
+			std::vector<uint16_t> unusedSamples;
+			for(const auto& sample : m_samples)
 			{
-				if(existingSample->GetIndex() == sample.GetIndex())
-				{
-					assert(existingSample->GetIndex() != sample.GetIndex());
-					return;
-				}
-			}
+				if(IsSampleUsed(sample->GetIndex())) { continue; }
+				
+				unusedSamples.emplace_back(sample->GetIndex());
 
-			if(sample.GetIndex() == std::numeric_limits<uint16_t>::max())
-			{
-				sample.SetIndex(static_cast<uint16_t>(m_samples.size()));	
+				// The chunk, its TOC entry and the sample data:
+				result.m_bytesReclaimed += FORM_CHUNK_MAX_NAME_LEN + sizeof(uint32_t) + EOS_E4_TOC_SIZE + E3SampleHeader::SIZE
+					+ sizeof(int16_t) * sample->GetRawSampleDataSize();
 			}
 
-			m_samples.emplace_back(std::make_shared<E3Sample>(std::move(sample)));
+			result.m_numSamplesRemoved = unusedSamples.size();
+			result.m_remap.m_isCompacted = true;
+			result.m_remap.m_samples = RemoveBatchFrom(m_samples, m_sampleTable, unusedSamples, true);
+			
+			ApplyRemap(result.m_remap);
+			return result;
+		}
+
+		/**
+		 * \brief Recreates the sample uses in one pass over every zone, needed after changing zones of presets in the bank directly.
+		 */
+		void RebuildSampleUses()
+		{
+			for(auto& uses : m_sampleUses) { uses.clear(); }
+			for(const auto& preset : m_presets) { AddSampleUses(*preset); }
 		}
 
-		void RemoveSample(const uint16_t sampleIndex)
+		/**
+		 * \return Every zone using the sample, kept up to date by AddPreset, RemovePreset, AddSampleZone and RemoveBatch
+		 */
+		[[nodiscard]] Span<const E4BSampleUse> GetSampleUses(const uint16_t sampleIndex) const
 		{
-			RemoveIfValid(m_samples, sampleIndex);
+			if(sampleIndex < m_sampleUses.size()) { return m_sampleUses[sampleIndex]; }
+			return {};
 		}
+
+		[[nodiscard]] bool IsSampleUsed(const uint16_t sampleIndex) const { return !GetSampleUses(sampleIndex).empty(); }
 		
 		void SetStartupPreset(const uint16_t presetIndex)
 		{
@@ -116,35 +225,17 @@ namespace simple_e4b
 
 		[[nodiscard]] std::weak_ptr<E4Preset> GetPreset(const uint16_t presetIndex) const
 		{
-			const auto& findResult(std::find_if(m_presets.begin(), m_presets.end(), [&](const auto& elem)
-			{
-				return elem->GetIndex() == presetIndex;
-			}));
-
-			if(findResult != m_presets.end()) { return std::weak_ptr<E4Preset>(*findResult); }
-			return std::weak_ptr<E4Preset>();
+			return FindInTable(m_presetTable, presetIndex);
 		}
 
 		[[nodiscard]] std::weak_ptr<E3Sample> GetSample(const uint16_t sampleIndex) const
 		{
-			const auto& findResult(std::find_if(m_samples.begin(), m_samples.end(), [&](const auto& elem)
-			{
-				return elem->GetIndex() == sampleIndex;
-			}));
-
-			if(findResult != m_samples.end()) { return std::weak_ptr<E3Sample>(*findResult); }
-			return std::weak_ptr<E3Sample>();
+			return FindInTable(m_sampleTable, sampleIndex);
 		}
 
 		[[nodiscard]] std::weak_ptr<E4Sequence> GetSequence(const uint16_t sequenceIndex) const
 		{
-			const auto& findResult(std::find_if(m_sequences.begin(), m_sequences.end(), [&](const auto& elem)
-			{
-				return elem->GetIndex() == sequenceIndex;
-			}));
-
-			if(findResult != m_sequences.end()) { return std::weak_ptr<E4Sequence>(*findResult); }
-			return std::weak_ptr<E4Sequence>();
+			return FindInTable(m_sequenceTable, sequenceIndex);
 		}
 
 		[[nodiscard]] const std::vector<std::shared_ptr<E4Preset> >& GetPresets() const { return m_presets; }
@@ -153,215 +244,1605 @@ namespace simple_e4b
 		[[nodiscard]] uint16_t GetStartupPreset() const { return m_startupPreset; }
 
 	private:
+		/*
+		 * Every element is also kept in a table addressed by its index, so lookups and duplicate checks don't have to scan the vectors.
+		 * SetIndex clamps to the maximum, so each table has one slot more than the maximum number of elements.
+		 * Indices must not be changed on elements already in the bank, as the tables would no longer match.
+		 */
+		
 		template<typename T>
-		void RemoveIfValid(std::vector<T>& vector, const uint16_t index)
+		using IndexTable = std::vector<std::shared_ptr<T> >;
+
+		template<typename T>
+		[[nodiscard]] static std::weak_ptr<T> FindInTable(const IndexTable<T>& table, const uint16_t index)
+		{
+			if(index < table.size()) { return std::weak_ptr<T>(table[index]); }
+			return std::weak_ptr<T>();
+		}
+		
+		/**
+		 * \return The added element, null if it wasn't added
+		 */
+		template<typename T>
+		static T* AddIfValid(std::vector<std::shared_ptr<T> >& vector, IndexTable<T>& table, T&& element, const size_t maxElements)
 		{
-			bool isValidIndex(false);
-			for(const auto& element : vector)
+			assert(vector.size() < maxElements);
+			if(vector.size() >= maxElements) { return nullptr; }
+
+			if(element.GetIndex() == std::numeric_limits<uint16_t>::max())
 			{
-				if(element->GetIndex() == index)
+				// Use the next index, or the first free one if that has already been taken:
+				uint16_t index(static_cast<uint16_t>(vector.size()));
+				if(table[index] != nullptr)
 				{
-					isValidIndex = true;
-					break;
+					index = static_cast<uint16_t>(std::distance(table.begin(), std::find(table.begin(), table.end(), nullptr)));
+				}
+				
+				element.SetIndex(index);
+			}
+			
+			const uint16_t index(element.GetIndex());
+			if(index >= table.size() || table[index] != nullptr)
+			{
+				assert(index < table.size() && table[index] == nullptr);
+				return nullptr;
+			}
+
+			table[index] = vector.emplace_back(std::make_shared<T>(std::move(element)));
+			return table[index].get();
+		}
+
+		void AddSampleUses(const E4Preset& preset)
+		{
+			const auto& voices(preset.GetVoices());
+			for(size_t voiceIndex(0); voiceIndex < voices.size(); ++voiceIndex)
+			{
+				const auto& zones(voices[voiceIndex].GetSampleZones());
+				for(size_t zoneIndex(0); zoneIndex < zones.size(); ++zoneIndex)
+				{
+					AddSampleUse(zones[zoneIndex].GetSampleIndex(), {preset.GetIndex(), static_cast<uint16_t>(voiceIndex), static_cast<uint8_t>(zoneIndex)});
+				}
+			}
+		}
+
+		void ApplyRemap(const E4BIndexRemap& remap)
+		{
+			if(!remap.m_samples.empty())
+			{
+				for(const auto& preset : m_presets)
+				{
+					for(auto& voice : preset->GetVoices())
+					{
+						auto& zones(voice.GetSampleZones());
+						zones.erase(std::remove_if(zones.begin(), zones.end(), [&](E4SampleZone& zone)
+						{
+							const uint16_t sampleIndex(remap.GetSample(zone.GetSampleIndex()));
+							if(sampleIndex == E4BIndexRemap::REMOVED) { return true; }
+							
+							zone.SetSampleIndex(sampleIndex);
+							return false;
+						}), zones.end());
+					}
 				}
 			}
 
+			if(m_startupPreset != std::numeric_limits<uint16_t>::max())
+			{
+				const uint16_t startupPreset(remap.GetPreset(m_startupPreset));
+				if(startupPreset != E4BIndexRemap::REMOVED) { m_startupPreset = startupPreset; }
+				else { m_startupPreset = m_presets.empty() ? std::numeric_limits<uint16_t>::max() : m_presets[0]->GetIndex(); }
+			}
+
+			// Zones may have moved within their voices, so the uses are rebuilt rather than patched:
+			RebuildSampleUses();
+		}
+		
+		void AddSampleUse(const uint16_t sampleIndex, const E4BSampleUse& use)
+		{
+			// Zones using an index no sample can have aren't tracked:
+			if(sampleIndex < m_sampleUses.size()) { m_sampleUses[sampleIndex].emplace_back(use); }
+		}
+
+		void RemoveSampleUses(const E4Preset& preset)
+		{
+			for(const auto& voice : preset.GetVoices())
+			{
+				for(const auto& zone : voice.GetSampleZones())
+				{
+					if(zone.GetSampleIndex() >= m_sampleUses.size()) { continue; }
+					
+					auto& uses(m_sampleUses[zone.GetSampleIndex()]);
+					uses.erase(std::remove_if(uses.begin(), uses.end(), [&](const E4BSampleUse& use)
+					{
+						return use.m_preset == preset.GetIndex();
+					}), uses.end());
+				}
+			}
+		}
+		
+		template<typename T>
+		static void RemoveIfValid(std::vector<std::shared_ptr<T> >& vector, IndexTable<T>& table, const uint16_t index)
+		{
+			const bool isValidIndex(index < table.size() && table[index] != nullptr);
 			assert(isValidIndex);
 			if(isValidIndex)
 			{
-				vector.erase(std::next(vector.begin(), static_cast<ptrdiff_t>(index)));
+				vector.erase(std::find(vector.begin(), vector.end(), table[index]));
+				table[index] = nullptr;
+			}
+		}
+
+		template<typename T>
+		static std::vector<uint16_t> RemoveBatchFrom(std::vector<std::shared_ptr<T> >& vector, IndexTable<T>& table, const Span<const uint16_t> indices,
+			const bool compactIndices)
+		{
+			std::vector<uint16_t> remap(table.size());
+			for(size_t index(0); index < remap.size(); ++index)
+			{
+				remap[index] = compactIndices && table[index] == nullptr ? E4BIndexRemap::REMOVED : static_cast<uint16_t>(index);
+			}
+
+			// An index listed more than once is only removed the first time:
+			std::vector<bool> isRemoved(table.size());
+			
+			bool isAnyRemoved(false);
+			for(const uint16_t index : indices)
+			{
+				if(index < isRemoved.size() && isRemoved[index]) { continue; }
+				
+				const bool isValidIndex(index < table.size() && table[index] != nullptr);
+				assert(isValidIndex);
+				if(isValidIndex)
+				{
+					isRemoved[index] = true;
+					table[index] = nullptr;
+					remap[index] = E4BIndexRemap::REMOVED;
+					isAnyRemoved = true;
+				}
+			}
+
+			if(isAnyRemoved)
+			{
+				vector.erase(std::remove_if(vector.begin(), vector.end(), [&](const auto& element)
+				{
+					return table[element->GetIndex()] == nullptr;
+				}), vector.end());
+			}
+
+			if(compactIndices)
+			{
+				// Renumber in index order, moving each element down to its new slot in the table:
+				uint16_t newIndex(0ui16);
+				for(size_t index(0); index < table.size(); ++index)
+				{
+					if(table[index] == nullptr) { continue; }
+
+					remap[index] = newIndex;
+					if(newIndex != index)
+					{
+						table[index]->SetIndex(newIndex);
+						table[newIndex] = std::move(table[index]);
+					}
+					
+					++newIndex;
+				}
+			}
+
+			// Left empty when every index is unchanged, so the remap has nothing to apply:
+			for(size_t index(0); index < remap.size(); ++index)
+			{
+				if(remap[index] != index) { return remap; }
 			}
+
+			return {};
 		}
 		
 		std::vector<std::shared_ptr<E4Preset> > m_presets{};
 		std::vector<std::shared_ptr<E3Sample> > m_samples{};
 		std::vector<std::shared_ptr<E4Sequence> > m_sequences{};
+		IndexTable<E4Preset> m_presetTable = IndexTable<E4Preset>(EOS_E4_MAX_PRESETS + 1);
+		IndexTable<E3Sample> m_sampleTable = IndexTable<E3Sample>(EOS_E4_MAX_SAMPLES + 1);
+		IndexTable<E4Sequence> m_sequenceTable = IndexTable<E4Sequence>(EOS_E4_MAX_SEQUENCES + 1);
+		std::vector<std::vector<E4BSampleUse> > m_sampleUses = std::vector<std::vector<E4BSampleUse> >(EOS_E4_MAX_SAMPLES + 1);
 		uint16_t m_startupPreset = 0ui16;
 	};
 
-	enum struct EE4BReadResult final
+	/**
+	 * \brief Handle to an element of a SlotMap, stays valid until that element is erased.
+	 */
+	template<typename T>
+	struct SlotHandle final
 	{
-		READ_SUCCESS, FILE_NOT_EXIST, FILE_INVALID
+		[[nodiscard]] bool IsValid() const { return m_slot != std::numeric_limits<uint32_t>::max(); }
+		[[nodiscard]] bool operator==(const SlotHandle& other) const { return m_slot == other.m_slot && m_generation == other.m_generation; }
+		[[nodiscard]] bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+		
+		uint32_t m_slot = std::numeric_limits<uint32_t>::max();
+		uint32_t m_generation = 0u;
 	};
-	
-	inline EE4BReadResult ReadE4B(const std::filesystem::path& e4bFile, E4BBank& outBank)
+
+	/**
+	 * \brief Stores elements contiguously, addressed by generation-checked handles.
+	 * Erasing moves the last element into the gap, so iteration order is not insertion order, but handles to other elements stay valid.
+	 */
+	template<typename T>
+	struct SlotMap final
 	{
-		const bool isEOSFileFormat(e4bFile.extension() == ".e4b" || e4bFile.extension() == ".E4B");
-		assert(isEOSFileFormat);
-		if(!isEOSFileFormat) { return EE4BReadResult::FILE_INVALID; }
+		using Handle = SlotHandle<T>;
 		
-		if (std::filesystem::exists(e4bFile))
+		SlotMap() = default;
+
+		void Reserve(const size_t numElements)
 		{
-			std::ifstream stream(e4bFile.c_str(), std::ios::binary);
-			if (stream.is_open())
+			m_values.reserve(numElements);
+			m_valueSlots.reserve(numElements);
+			m_slots.reserve(numElements);
+		}
+		
+		Handle Insert(T&& value)
+		{
+			uint32_t slotIndex;
+			if(!m_freeSlots.empty())
 			{
-				FORMChunk form;
-				form.Read(stream);
-
-				if (form.GetName() == "FORM")
-				{
-					std::array<char, 4> E4B0{};
-					stream.read(E4B0.data(), static_cast<std::streamsize>(E4B0.size()));
+				slotIndex = m_freeSlots.back();
+				m_freeSlots.pop_back();
+			}
+			else
+			{
+				slotIndex = static_cast<uint32_t>(m_slots.size());
+				m_slots.emplace_back();
+			}
 
-					if (std::string_view{E4B0.data(), E4B0.size()} == "E4B0")
-					{
-						FORMChunk TOC;
-						TOC.Read(stream);
-						
-						if (TOC.GetName() == "TOC1")
-						{
-							const uint32_t numSubchunks(TOC.GetReadSize() / EOS_E4_TOC_SIZE);
-							assert(numSubchunks > 0u);
+			Slot& slot(m_slots[slotIndex]);
+			slot.m_valueIndex = static_cast<uint32_t>(m_values.size());
+			
+			m_values.emplace_back(std::move(value));
+			m_valueSlots.emplace_back(slotIndex);
+			
+			return {slotIndex, slot.m_generation};
+		}
 
-							if(numSubchunks > 0u)
-							{
-								for(uint32_t i(0u); i < numSubchunks; ++i)
-								{
-									// Cache the last position:
-									const int64_t cachedStreamPos(stream.tellg());
-									
-									FORMChunk subChunk;
-									subChunk.Read(stream);
+		/**
+		 * \return Whether the handle referred to an element
+		 */
+		bool Erase(const Handle handle)
+		{
+			if(!Contains(handle)) { return false; }
 
-									uint32_t subchunkPos(0u);
-									stream.read(reinterpret_cast<char*>(&subchunkPos), sizeof(uint32_t));
-									subchunkPos = byteswap_helpers::byteswap_uint32(subchunkPos);
+			Slot& slot(m_slots[handle.m_slot]);
+			const uint32_t valueIndex(slot.m_valueIndex);
+			const uint32_t lastValueIndex(static_cast<uint32_t>(m_values.size() - 1u));
+			
+			if(valueIndex != lastValueIndex)
+			{
+				m_values[valueIndex] = std::move(m_values[lastValueIndex]);
+				m_valueSlots[valueIndex] = m_valueSlots[lastValueIndex];
+				m_slots[m_valueSlots[valueIndex]].m_valueIndex = valueIndex;
+			}
 
-									// Skip to the actual data location:
-									stream.seekg(subchunkPos + static_cast<uint32_t>(FORM_CHUNK_MAX_NAME_LEN + sizeof(uint32_t)));
+			m_values.pop_back();
+			m_valueSlots.pop_back();
 
-									if (subChunk.GetName() == "E4P1")
-									{
-										E4Preset preset;
-										preset.Read(stream);
+			// Invalidates every handle to this slot:
+			++slot.m_generation;
+			m_freeSlots.emplace_back(handle.m_slot);
+			
+			return true;
+		}
 
-										outBank.AddPreset(std::move(preset));
-									}
-									else if (subChunk.GetName() == "E3S1")
-									{
-										E3Sample sample;
-										sample.Read(stream, subChunk.GetReadSize() + 2u);
+		void Clear()
+		{
+			for(uint32_t valueIndex(0u); valueIndex < m_values.size(); ++valueIndex)
+			{
+				const uint32_t slotIndex(m_valueSlots[valueIndex]);
+				++m_slots[slotIndex].m_generation;
+				m_freeSlots.emplace_back(slotIndex);
+			}
 
-										outBank.AddSample(std::move(sample));
-									}
-									else if(subChunk.GetName() == "E4s1")
-									{
-										E4Sequence sequence;
-										sequence.Read(stream, subChunk.GetReadSize() + 2u);
+			m_values.clear();
+			m_valueSlots.clear();
+		}
 
-										outBank.AddSequence(std::move(sequence));
-									}
-									else if (subChunk.GetName() == "E4Ma" || subChunk.GetName() == "EMS0")
-									{
-										// TODO: E4Ma & Multisetup
-										std::cout << "Skipping " << subChunk.GetName() << "!\n";
-										stream.ignore(subChunk.GetReadSize());
-									}
-									else
-									{
-										return EE4BReadResult::FILE_INVALID;
-									}
+		[[nodiscard]] bool Contains(const Handle handle) const
+		{
+			return handle.m_slot < m_slots.size() && m_slots[handle.m_slot].m_generation == handle.m_generation;
+		}
+		
+		[[nodiscard]] T* Get(const Handle handle)
+		{
+			return Contains(handle) ? &m_values[m_slots[handle.m_slot].m_valueIndex] : nullptr;
+		}
+		
+		[[nodiscard]] const T* Get(const Handle handle) const
+		{
+			return Contains(handle) ? &m_values[m_slots[handle.m_slot].m_valueIndex] : nullptr;
+		}
 
-									// Go to the next location, if applicable:
-									if(i + 1u < numSubchunks)
-									{
-										stream.seekg(cachedStreamPos + static_cast<std::streampos>(EOS_E4_TOC_SIZE));	
-									}
-									else
-									{
-										if(!stream.eof())
-										{
-											subChunk = FORMChunk();
-											subChunk.Read(stream);
-
-											if (subChunk.GetName() == "EMSt")
-											{
-												E4EMSt startup;
-												startup.Read(stream);
-												
-												outBank.SetStartupPreset(startup.GetCurrentPreset());
-											}
-										}
-									}
-								}
+		/**
+		 * \return Handle to the element at a position in iteration order
+		 */
+		[[nodiscard]] Handle GetHandle(const size_t valueIndex) const
+		{
+			if(valueIndex >= m_values.size()) { return {}; }
+			
+			const uint32_t slotIndex(m_valueSlots[valueIndex]);
+			return {slotIndex, m_slots[slotIndex].m_generation};
+		}
 
-								return EE4BReadResult::READ_SUCCESS;
-							}
-						}	
-					}
+		[[nodiscard]] Span<T> GetValues() { return m_values; }
+		[[nodiscard]] Span<const T> GetValues() const { return m_values; }
+		
+		[[nodiscard]] T* begin() { return m_values.data(); }
+		[[nodiscard]] T* end() { return std::next(m_values.data(), static_cast<ptrdiff_t>(m_values.size())); }
+		[[nodiscard]] const T* begin() const { return m_values.data(); }
+		[[nodiscard]] const T* end() const { return std::next(m_values.data(), static_cast<ptrdiff_t>(m_values.size())); }
+		[[nodiscard]] size_t size() const { return m_values.size(); }
+		[[nodiscard]] bool empty() const { return m_values.empty(); }
 
-					return EE4BReadResult::FILE_INVALID;
-				}
-			}
-		}
+	private:
+		struct Slot final
+		{
+			uint32_t m_valueIndex = 0u;
+			uint32_t m_generation = 0u;
+		};
 		
-		return EE4BReadResult::FILE_NOT_EXIST;
-	}
+		std::vector<T> m_values{};
+		std::vector<uint32_t> m_valueSlots{}; // Slot of each value
+		std::vector<Slot> m_slots{};
+		std::vector<uint32_t> m_freeSlots{};
+	};
 
-	inline void WriteE4B(const std::filesystem::path& e4bFile, const E4BBank& inBank)
+	/**
+	 * \brief Alternative to E4BBank which stores presets, samples and sequences contiguously rather than each behind a shared_ptr.
+	 * Elements are addressed by handles, which stay valid across the removal of other elements.
+	 */
+	struct E4BSlotBank final
 	{
-		const bool isEOSFileFormat(e4bFile.extension() == ".e4b" || e4bFile.extension() == ".E4B");
-		assert(isEOSFileFormat);
-		if(!isEOSFileFormat) { return; }
+		using PresetHandle = SlotHandle<E4Preset>;
+		using SampleHandle = SlotHandle<E3Sample>;
+		using SequenceHandle = SlotHandle<E4Sequence>;
 		
-		std::ofstream stream(e4bFile.c_str(), std::ios::binary);
-		if (stream.is_open())
+		E4BSlotBank() = default;
+
+		/**
+		 * \brief Takes over the elements of the bank.
+		 */
+		explicit E4BSlotBank(E4BBank&& bank)
 		{
-			FORMChunk FORM("FORM");
+			m_presets.Reserve(bank.GetPresets().size());
+			for(const auto& preset : bank.GetPresets()) { AddPreset(std::move(*preset)); }
+			
+			m_samples.Reserve(bank.GetSamples().size());
+			for(const auto& sample : bank.GetSamples()) { AddSample(std::move(*sample)); }
+			
+			m_sequences.Reserve(bank.GetSequences().size());
+			for(const auto& sequence : bank.GetSequences()) { AddSequence(std::move(*sequence)); }
 
-			constexpr std::string_view E4B0("E4B0");
-			FORM.writeType(E4B0.data(), E4B0.length());
+			m_startupPreset = bank.GetStartupPreset();
+			bank = E4BBank();
+		}
 
-			FORM.m_subChunks.emplace_back("TOC1");
+		/**
+		 * \brief Moves the elements into an E4BBank, such as for WriteE4B. Leaves this bank empty.
+		 */
+		[[nodiscard]] E4BBank ToBank()
+		{
+			E4BBank bank;
+			for(auto& preset : m_presets) { bank.AddPreset(std::move(preset)); }
+			for(auto& sample : m_samples) { bank.AddSample(std::move(sample)); }
+			for(auto& sequence : m_sequences) { bank.AddSequence(std::move(sequence)); }
 
-			const auto AddTOCIndex([&](const FORMChunk& subChunk, uint16_t index, const std::string& name)
-			{
-				FORMChunk TOCSubchunk(std::string(subChunk.GetName()), subChunk.GetFullSize(false) - 2u);
+			if(!bank.GetPresets().empty()) { bank.SetStartupPreset(m_startupPreset); }
+			
+			*this = E4BSlotBank();
+			return bank;
+		}
+		
+		PresetHandle AddPreset(E4Preset&& preset)
+		{
+			return AddIfValid(m_presets, m_presetTable, std::move(preset), EOS_E4_MAX_PRESETS);
+		}
 
-				// Get the offset including this TOC subchunk:
-				const uint32_t chunkLoc(byteswap_helpers::byteswap_uint32(FORM.GetFullSize(true) + EOS_E4_TOC_SIZE));
-				TOCSubchunk.writeType(&chunkLoc, sizeof(uint32_t));
+		void RemovePreset(const PresetHandle handle)
+		{
+			RemoveIfValid(m_presets, m_presetTable, handle);
+		}
 
-				index = byteswap_helpers::byteswap_uint16(index);
-				TOCSubchunk.writeType(&index, sizeof(uint16_t));
+		SampleHandle AddSample(E3Sample&& sample)
+		{
+			return AddIfValid(m_samples, m_sampleTable, std::move(sample), EOS_E4_MAX_SAMPLES);
+		}
+
+		void RemoveSample(const SampleHandle handle)
+		{
+			RemoveIfValid(m_samples, m_sampleTable, handle);
+		}
 
-				TOCSubchunk.writeType(name.c_str(), name.length());
+		SequenceHandle AddSequence(E4Sequence&& sequence)
+		{
+			return AddIfValid(m_sequences, m_sequenceTable, std::move(sequence), EOS_E4_MAX_SEQUENCES);
+		}
 
-				const char* null(nullptr);
-				TOCSubchunk.writeType(null, sizeof(uint16_t));
+		void RemoveSequence(const SequenceHandle handle)
+		{
+			RemoveIfValid(m_sequences, m_sequenceTable, handle);
+		}
 
-				FORMChunk& TOC(FORM.m_subChunks[0]);
-				TOC.m_subChunks.emplace_back(std::move(TOCSubchunk));
-			});
+		void SetStartupPreset(const uint16_t presetIndex)
+		{
+			assert(!m_presets.empty());
+			if(m_presets.empty()) { return; }
 			
-			for(const auto& preset : inBank.GetPresets())
+			// Startup preset is set to 'None', which is valid behavior.
+			if(presetIndex == std::numeric_limits<uint16_t>::max() || FindPreset(presetIndex).IsValid())
 			{
-				FORMChunk E4P1("E4P1");
-				preset->Write(E4P1);
-
-				AddTOCIndex(E4P1, preset->GetIndex(), preset->GetName());
-				
-				FORM.m_subChunks.emplace_back(std::move(E4P1));
+				m_startupPreset = presetIndex;
 			}
-			
-			for(const auto& sample : inBank.GetSamples())
+			else
 			{
-				FORMChunk E3S1("E3S1");
-				sample->Write(E3S1);
+				// Otherwise, set to the first valid index:
+				m_startupPreset = m_presets.begin()->GetIndex();
+			}
+		}
+		
+		/**
+		 * \return Handle to the preset with this index, invalid if there is none
+		 */
+		[[nodiscard]] PresetHandle FindPreset(const uint16_t presetIndex) const { return FindInTable(m_presetTable, presetIndex); }
+		[[nodiscard]] SampleHandle FindSample(const uint16_t sampleIndex) const { return FindInTable(m_sampleTable, sampleIndex); }
+		[[nodiscard]] SequenceHandle FindSequence(const uint16_t sequenceIndex) const { return FindInTable(m_sequenceTable, sequenceIndex); }
+
+		/**
+		 * \return Null if the handle is no longer valid
+		 */
+		[[nodiscard]] E4Preset* GetPreset(const PresetHandle handle) { return m_presets.Get(handle); }
+		[[nodiscard]] const E4Preset* GetPreset(const PresetHandle handle) const { return m_presets.Get(handle); }
+		[[nodiscard]] E3Sample* GetSample(const SampleHandle handle) { return m_samples.Get(handle); }
+		[[nodiscard]] const E3Sample* GetSample(const SampleHandle handle) const { return m_samples.Get(handle); }
+		[[nodiscard]] E4Sequence* GetSequence(const SequenceHandle handle) { return m_sequences.Get(handle); }
+		[[nodiscard]] const E4Sequence* GetSequence(const SequenceHandle handle) const { return m_sequences.Get(handle); }
+		
+		[[nodiscard]] const SlotMap<E4Preset>& GetPresets() const { return m_presets; }
+		[[nodiscard]] const SlotMap<E3Sample>& GetSamples() const { return m_samples; }
+		[[nodiscard]] const SlotMap<E4Sequence>& GetSequences() const { return m_sequences; }
+		[[nodiscard]] uint16_t GetStartupPreset() const { return m_startupPreset; }
+
+	private:
+		// As in E4BBank, handles are also kept in tables addressed by index.
+		template<typename T>
+		using IndexTable = std::vector<SlotHandle<T> >;
+
+		template<typename T>
+		[[nodiscard]] static SlotHandle<T> FindInTable(const IndexTable<T>& table, const uint16_t index)
+		{
+			if(index < table.size()) { return table[index]; }
+			return {};
+		}
+		
+		template<typename T>
+		static SlotHandle<T> AddIfValid(SlotMap<T>& slotMap, IndexTable<T>& table, T&& element, const size_t maxElements)
+		{
+			assert(slotMap.size() < maxElements);
+			if(slotMap.size() >= maxElements) { return {}; }
+
+			if(element.GetIndex() == std::numeric_limits<uint16_t>::max())
+			{
+				// Use the next index, or the first free one if that has already been taken:
+				uint16_t index(static_cast<uint16_t>(slotMap.size()));
+				if(table[index].IsValid())
+				{
+					index = static_cast<uint16_t>(std::distance(table.begin(), std::find_if(table.begin(), table.end(), [](const auto& handle)
+					{
+						return !handle.IsValid();
+					})));
+				}
+				
+				element.SetIndex(index);
+			}
+			
+			const uint16_t index(element.GetIndex());
+			if(index >= table.size() || table[index].IsValid())
+			{
+				assert(index < table.size() && !table[index].IsValid());
+				return {};
+			}
+
+			table[index] = slotMap.Insert(std::move(element));
+			return table[index];
+		}
+		
+		template<typename T>
+		static void RemoveIfValid(SlotMap<T>& slotMap, IndexTable<T>& table, const SlotHandle<T> handle)
+		{
+			const T* element(slotMap.Get(handle));
+			assert(element != nullptr);
+			if(element != nullptr)
+			{
+				table[element->GetIndex()] = {};
+				slotMap.Erase(handle);
+			}
+		}
+		
+		SlotMap<E4Preset> m_presets{};
+		SlotMap<E3Sample> m_samples{};
+		SlotMap<E4Sequence> m_sequences{};
+		IndexTable<E4Preset> m_presetTable = IndexTable<E4Preset>(EOS_E4_MAX_PRESETS + 1);
+		IndexTable<E3Sample> m_sampleTable = IndexTable<E3Sample>(EOS_E4_MAX_SAMPLES + 1);
+		IndexTable<E4Sequence> m_sequenceTable = IndexTable<E4Sequence>(EOS_E4_MAX_SEQUENCES + 1);
+		uint16_t m_startupPreset = 0ui16;
+	};
+
+	enum struct EE4BReadResult final
+	{
+		READ_SUCCESS, FILE_NOT_EXIST, FILE_INVALID
+	};
+
+	struct E4BReadOptions final
+	{
+		// Parse the bank straight out of a read-only memory mapping of the file instead of through an std::ifstream.
+		// Sample data is then viewed in place, and the mapping stays alive for as long as a sample references it.
+		// On Windows a mapped file can't be replaced, so WriteE4B back over it fails while any sample still views it (POSIX is unaffected).
+		bool m_memoryMapped = false;
+
+		// Only read sample headers up front, each sample's data is read from the file the first time it is accessed.
+		// Mapped reading already behaves like this, as the mapped pages are only read in when touched.
+		bool m_deferSampleData = false;
+
+		// Number of threads decoding the chunks listed in TOC1 concurrently, 0 uses every hardware thread.
+		// Anything other than 1 reads through a memory mapping, sample data is still copied unless m_memoryMapped is set.
+		uint32_t m_numThreads = 1u;
+	};
+
+	/**
+	 * \brief Read-only memory mapping of an entire file.
+	 */
+	struct MappedFile final
+	{
+		explicit MappedFile(const std::filesystem::path& file)
+		{
+#ifdef _WIN32
+			m_file = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if(m_file == INVALID_HANDLE_VALUE) { return; }
+
+			LARGE_INTEGER fileSize{};
+			if(GetFileSizeEx(m_file, &fileSize) == 0 || fileSize.QuadPart <= 0) { return; }
+
+			m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if(m_mapping == nullptr) { return; }
+
+			const void* view(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+			if(view == nullptr) { return; }
+
+			m_data = static_cast<const char*>(view);
+			m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+			const int fd(open(file.c_str(), O_RDONLY));
+			if(fd == -1) { return; }
+
+			struct stat fileStat{};
+			if(fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+			{
+				void* view(mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0));
+				if(view != MAP_FAILED)
+				{
+					m_data = static_cast<const char*>(view);
+					m_size = static_cast<size_t>(fileStat.st_size);
+				}
+			}
+
+			// The mapping stays valid after the descriptor is closed.
+			close(fd);
+#endif
+		}
+
+		~MappedFile()
+		{
+#ifdef _WIN32
+			if(m_data != nullptr) { UnmapViewOfFile(m_data); }
+			if(m_mapping != nullptr) { CloseHandle(m_mapping); }
+			if(m_file != INVALID_HANDLE_VALUE) { CloseHandle(m_file); }
+#else
+			if(m_data != nullptr) { munmap(const_cast<char*>(m_data), m_size); }
+#endif
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		[[nodiscard]] bool IsOpen() const { return m_data != nullptr; }
+		[[nodiscard]] const char* GetData() const { return m_data; }
+		[[nodiscard]] size_t GetSize() const { return m_size; }
+
+	private:
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+
+#ifdef _WIN32
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = nullptr;
+#endif
+	};
+
+	/**
+	 * \brief Collects the pieces of a file and hands them to the OS in as few calls as possible (writev where available).
+	 * Small pieces such as chunk headers are staged, large ones such as sample data are referenced in place and must outlive Flush.
+	 */
+	struct GatherFileWriter final
+	{
+		GatherFileWriter() = default;
+
+		// std::ostream-like, so chunks can be written to this directly:
+		void write(const char* data, const std::streamsize count)
+		{
+			if(count <= 0) { return; }
+			
+			if(m_segments.empty() || m_segments.back().m_data != nullptr)
+			{
+				m_segments.push_back({nullptr, m_stagedData.size(), 0});
+			}
+
+			m_stagedData.insert(m_stagedData.end(), data, std::next(data, count));
+			m_segments.back().m_size += static_cast<size_t>(count);
+		}
+
+		void WriteInPlace(const Span<const char> data)
+		{
+			if(!data.empty()) { m_segments.push_back({data.data(), 0, data.size()}); }
+		}
+
+		/**
+		 * \brief Writes everything to a temporary file next to file, then renames it over file.
+		 * In place segments may point into a mapping of file itself (a bank read with m_memoryMapped), which truncating file first would destroy.
+		 * On POSIX the mapping keeps the replaced file alive. Windows refuses to rename over a mapped file, so writing over the mapped file fails there.
+		 * \return false if anything failed, file is then left as it was
+		 */
+		[[nodiscard]] bool Flush(const std::filesystem::path& file) const
+		{
+			std::filesystem::path tempFile(file);
+			tempFile += ".tmp";
+
+			std::error_code error;
+			if(WriteFile(tempFile))
+			{
+				std::filesystem::rename(tempFile, file, error);
+				if(!error) { return true; }
+			}
+
+			std::filesystem::remove(tempFile, error);
+			return false;
+		}
+
+	private:
+		struct Segment final
+		{
+			const char* m_data = nullptr; // Null when staged
+			size_t m_stagedOffset = 0;
+			size_t m_size = 0;
+		};
+
+		[[nodiscard]] bool WriteFile(const std::filesystem::path& file) const
+		{
+#ifdef _WIN32
+			std::ofstream stream(file.c_str(), std::ios::binary);
+			if(!stream.is_open()) { return false; }
+
+			for(const auto& segment : m_segments)
+			{
+				stream.write(GetSegmentData(segment), static_cast<std::streamsize>(segment.m_size));
+			}
+
+			return stream.good();
+#else
+			const int fd(open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+			if(fd == -1) { return false; }
+
+			std::vector<iovec> ioVectors;
+			ioVectors.reserve(m_segments.size());
+			for(const auto& segment : m_segments)
+			{
+				ioVectors.push_back({const_cast<char*>(GetSegmentData(segment)), segment.m_size});
+			}
+
+			bool isWritten(true);
+			size_t ioVectorPos(0);
+			while(ioVectorPos < ioVectors.size())
+			{
+				const int numIOVectors(static_cast<int>(std::min(ioVectors.size() - ioVectorPos, static_cast<size_t>(IOV_MAX))));
+				ssize_t numWritten(writev(fd, &ioVectors[ioVectorPos], numIOVectors));
+				if(numWritten < 0)
+				{
+					if(errno == EINTR) { continue; }
+					
+					isWritten = false;
+					break;
+				}
+
+				// Skip past what was written, which may end partway into a vector:
+				while(numWritten > 0)
+				{
+					iovec& ioVector(ioVectors[ioVectorPos]);
+					if(static_cast<size_t>(numWritten) >= ioVector.iov_len)
+					{
+						numWritten -= static_cast<ssize_t>(ioVector.iov_len);
+						++ioVectorPos;
+					}
+					else
+					{
+						ioVector.iov_base = std::next(static_cast<char*>(ioVector.iov_base), numWritten);
+						ioVector.iov_len -= static_cast<size_t>(numWritten);
+						numWritten = 0;
+					}
+				}
+
+				// Empty vectors are never added, so this only skips trailing ones left by a partial write:
+				while(ioVectorPos < ioVectors.size() && ioVectors[ioVectorPos].iov_len == 0) { ++ioVectorPos; }
+			}
+
+			// Flushed to disk before the rename, so a crash can't leave a renamed but incomplete file:
+			isWritten = isWritten && fsync(fd) == 0;
+			return close(fd) == 0 && isWritten;
+#endif
+		}
+
+		[[nodiscard]] const char* GetSegmentData(const Segment& segment) const
+		{
+			return segment.m_data != nullptr ? segment.m_data : std::next(m_stagedData.data(), static_cast<ptrdiff_t>(segment.m_stagedOffset));
+		}
+		
+		std::vector<Segment> m_segments{};
+		std::vector<char> m_stagedData{};
+	};
+
+	namespace read_helpers
+	{
+		template<typename Stream>
+		void ReadSample(Stream& stream, E3Sample& outSample, const size_t subChunkSize, const E4BReadOptions& options, const std::filesystem::path& e4bFile)
+		{
+			// Samples viewed in place already only read their data when accessed.
+			bool isViewedInPlace(false);
+			if constexpr(std::is_same_v<Stream, MemoryStream>) { isViewedInPlace = stream.GetOwner() != nullptr; }
+			
+			if(options.m_deferSampleData && !isViewedInPlace)
+			{
+				outSample.ReadDeferred(stream, subChunkSize, e4bFile);
+			}
+			else
+			{
+				outSample.Read(stream, subChunkSize);
+			}
+		}
+		
+		template<typename Stream>
+		EE4BReadResult ReadE4BStream(Stream& stream, E4BBank& outBank, const E4BReadOptions& options, const std::filesystem::path& e4bFile)
+		{
+			FORMChunk form;
+			form.Read(stream);
+
+			if (form.GetName() == "FORM")
+			{
+				std::array<char, 4> E4B0{};
+				stream.read(E4B0.data(), static_cast<std::streamsize>(E4B0.size()));
+
+				if (std::string_view{E4B0.data(), E4B0.size()} == "E4B0")
+				{
+					FORMChunk TOC;
+					TOC.Read(stream);
+					
+					if (TOC.GetName() == "TOC1")
+					{
+						const uint32_t numSubchunks(TOC.GetReadSize() / EOS_E4_TOC_SIZE);
+						assert(numSubchunks > 0u);
+
+						if(numSubchunks > 0u)
+						{
+							for(uint32_t i(0u); i < numSubchunks; ++i)
+							{
+								// Cache the last position:
+								const int64_t cachedStreamPos(stream.tellg());
+								
+								FORMChunk subChunk;
+								subChunk.Read(stream);
+
+								uint32_t subchunkPos(0u);
+								stream.read(reinterpret_cast<char*>(&subchunkPos), sizeof(uint32_t));
+								subchunkPos = byteswap_helpers::byteswap_uint32(subchunkPos);
+
+								// Skip to the actual data location:
+								stream.seekg(subchunkPos + static_cast<uint32_t>(FORM_CHUNK_MAX_NAME_LEN + sizeof(uint32_t)));
+
+								if (subChunk.GetName() == "E4P1")
+								{
+									E4Preset preset;
+									preset.Read(stream);
+
+									outBank.AddPreset(std::move(preset));
+								}
+								else if (subChunk.GetName() == "E3S1")
+								{
+									E3Sample sample;
+									ReadSample(stream, sample, subChunk.GetReadSize() + 2u, options, e4bFile);
+
+									outBank.AddSample(std::move(sample));
+								}
+								else if(subChunk.GetName() == "E4s1")
+								{
+									E4Sequence sequence;
+									sequence.Read(stream, subChunk.GetReadSize() + 2u);
+
+									outBank.AddSequence(std::move(sequence));
+								}
+								else if (subChunk.GetName() == "E4Ma" || subChunk.GetName() == "EMS0")
+								{
+									// TODO: E4Ma & Multisetup
+									std::cout << "Skipping " << subChunk.GetName() << "!\n";
+									stream.ignore(subChunk.GetReadSize());
+								}
+								else
+								{
+									return EE4BReadResult::FILE_INVALID;
+								}
+
+								// Go to the next location, if applicable:
+								if(i + 1u < numSubchunks)
+								{
+									stream.seekg(cachedStreamPos + static_cast<std::streampos>(EOS_E4_TOC_SIZE));	
+								}
+								else
+								{
+									if(!stream.eof())
+									{
+										subChunk = FORMChunk();
+										subChunk.Read(stream);
+
+										if (subChunk.GetName() == "EMSt")
+										{
+											E4EMSt startup;
+											startup.Read(stream);
+											
+											outBank.SetStartupPreset(startup.GetCurrentPreset());
+										}
+									}
+								}
+							}
+
+							return EE4BReadResult::READ_SUCCESS;
+						}
+					}	
+				}
+			}
+
+			return EE4BReadResult::FILE_INVALID;
+		}
+
+		/**
+		 * \brief Decodes every chunk listed in TOC1 on a pool of threads, then adds them to the bank in TOC order.
+		 */
+		inline EE4BReadResult ReadE4BParallel(const Span<const char> e4bData, const std::shared_ptr<const void>& owner, E4BBank& outBank,
+			const E4BReadOptions& options, const std::filesystem::path& e4bFile)
+		{
+			MemoryStream stream(e4bData);
+			
+			FORMChunk form;
+			form.Read(stream);
+
+			std::array<char, 4> E4B0{};
+			stream.read(E4B0.data(), static_cast<std::streamsize>(E4B0.size()));
+
+			if (form.GetName() != "FORM" || std::string_view{E4B0.data(), E4B0.size()} != "E4B0") { return EE4BReadResult::FILE_INVALID; }
+
+			FORMChunk TOC;
+			TOC.Read(stream);
+
+			// Everything below is sized by the TOC up front, so it can't list more than the file holds or a bank can have (plus E4Ma & EMS0):
+			constexpr size_t MAX_SUBCHUNKS((EOS_E4_MAX_PRESETS + 1u) + (EOS_E4_MAX_SAMPLES + 1u) + (EOS_E4_MAX_SEQUENCES + 1u) + 2u);
+			
+			const uint32_t numSubchunks(TOC.GetReadSize() / EOS_E4_TOC_SIZE);
+			if (TOC.GetName() != "TOC1" || numSubchunks == 0u || numSubchunks > stream.GetRemaining() / EOS_E4_TOC_SIZE || numSubchunks > MAX_SUBCHUNKS)
+			{
+				return EE4BReadResult::FILE_INVALID;
+			}
+
+			struct TOCEntry final
+			{
+				FORMChunk m_subChunk;
+				uint32_t m_subchunkPos = 0u;
+			};
+
+			std::vector<TOCEntry> entries(numSubchunks);
+			for(auto& entry : entries)
+			{
+				entry.m_subChunk.Read(stream);
+				
+				stream.read(reinterpret_cast<char*>(&entry.m_subchunkPos), sizeof(uint32_t));
+				entry.m_subchunkPos = byteswap_helpers::byteswap_uint32(entry.m_subchunkPos);
+
+				stream.ignore(EOS_E4_TOC_SIZE - FORM_CHUNK_MAX_NAME_LEN - sizeof(uint32_t) * 2u);
+
+				const std::string_view name(entry.m_subChunk.GetName());
+				if(name != "E4P1" && name != "E3S1" && name != "E4s1" && name != "E4Ma" && name != "EMS0")
+				{
+					return EE4BReadResult::FILE_INVALID;
+				}
+			}
+
+			using DecodedChunk = std::variant<std::monostate, E4Preset, E3Sample, E4Sequence>;
+			std::vector<DecodedChunk> decodedChunks(numSubchunks);
+
+			uint32_t numThreads(options.m_numThreads > 0u ? options.m_numThreads : std::max(std::thread::hardware_concurrency(), 1u));
+			numThreads = std::min(numThreads, numSubchunks);
+
+			// An exception can't leave a worker, so each thread's is kept and rethrown once they have all been joined:
+			std::vector<std::exception_ptr> exceptions(numThreads);
+			
+			std::atomic<uint32_t> nextChunk(0u);
+			const auto decodeChunks([&](const uint32_t threadIndex)
+			{
+				try
+				{
+					// Each thread parses through its own cursor, the data itself is shared:
+					MemoryStream chunkStream(e4bData, owner);
+					
+					for(uint32_t i(nextChunk++); i < numSubchunks; i = nextChunk++)
+					{
+						const TOCEntry& entry(entries[i]);
+						chunkStream.seekg(entry.m_subchunkPos + static_cast<uint32_t>(FORM_CHUNK_MAX_NAME_LEN + sizeof(uint32_t)));
+						
+						if (entry.m_subChunk.GetName() == "E4P1")
+						{
+							E4Preset preset;
+							preset.Read(chunkStream);
+
+							decodedChunks[i] = std::move(preset);
+						}
+						else if (entry.m_subChunk.GetName() == "E3S1")
+						{
+							E3Sample sample;
+							ReadSample(chunkStream, sample, entry.m_subChunk.GetReadSize() + 2u, options, e4bFile);
+
+							decodedChunks[i] = std::move(sample);
+						}
+						else if (entry.m_subChunk.GetName() == "E4s1")
+						{
+							E4Sequence sequence;
+							sequence.Read(chunkStream, entry.m_subChunk.GetReadSize() + 2u);
+
+							decodedChunks[i] = std::move(sequence);
+						}
+					}
+				}
+				catch(...)
+				{
+					exceptions[threadIndex] = std::current_exception();
+
+					// Stop every thread from taking further chunks:
+					nextChunk = numSubchunks;
+				}
+			});
+
+			std::vector<std::thread> workers;
+			workers.reserve(numThreads - 1u);
+			for(uint32_t i(1u); i < numThreads; ++i) { workers.emplace_back(decodeChunks, i); }
+
+			decodeChunks(0u);
+			
+			for(auto& worker : workers) { worker.join(); }
+
+			for(const auto& exception : exceptions)
+			{
+				if(exception) { std::rethrow_exception(exception); }
+			}
+
+			for(uint32_t i(0u); i < numSubchunks; ++i)
+			{
+				auto& decodedChunk(decodedChunks[i]);
+				if(auto* preset = std::get_if<E4Preset>(&decodedChunk)) { outBank.AddPreset(std::move(*preset)); }
+				else if(auto* sample = std::get_if<E3Sample>(&decodedChunk)) { outBank.AddSample(std::move(*sample)); }
+				else if(auto* sequence = std::get_if<E4Sequence>(&decodedChunk)) { outBank.AddSequence(std::move(*sequence)); }
+			}
+
+			// The startup chunk follows the last chunk listed in TOC1:
+			const TOCEntry& lastEntry(entries.back());
+			stream.seekg(lastEntry.m_subchunkPos + static_cast<uint32_t>(FORM_CHUNK_MAX_NAME_LEN + sizeof(uint32_t)) + lastEntry.m_subChunk.GetReadSize() + 2u);
+
+			FORMChunk startupChunk;
+			startupChunk.Read(stream);
+
+			if (!stream.eof() && startupChunk.GetName() == "EMSt")
+			{
+				E4EMSt startup;
+				startup.Read(stream);
+				
+				outBank.SetStartupPreset(startup.GetCurrentPreset());
+			}
+
+			return EE4BReadResult::READ_SUCCESS;
+		}
+	}
+	
+	inline EE4BReadResult ReadE4B(const std::filesystem::path& e4bFile, E4BBank& outBank, const E4BReadOptions& options = E4BReadOptions())
+	{
+		const bool isEOSFileFormat(e4bFile.extension() == ".e4b" || e4bFile.extension() == ".E4B");
+		assert(isEOSFileFormat);
+		if(!isEOSFileFormat) { return EE4BReadResult::FILE_INVALID; }
+		
+		if (std::filesystem::exists(e4bFile))
+		{
+			const bool isParallel(options.m_numThreads != 1u);
+			if(options.m_memoryMapped || isParallel)
+			{
+				auto mappedFile(std::make_shared<const MappedFile>(e4bFile));
+				if(mappedFile->IsOpen())
+				{
+					// Only share ownership of the mapping when samples may view it in place:
+					const std::shared_ptr<const void> owner(options.m_memoryMapped ? mappedFile : nullptr);
+					if(isParallel)
+					{
+						return read_helpers::ReadE4BParallel(Span<const char>(mappedFile->GetData(), mappedFile->GetSize()), owner, outBank, options, e4bFile);
+					}
+					
+					MemoryStream stream(mappedFile->GetData(), mappedFile->GetSize(), owner);
+					return read_helpers::ReadE4BStream(stream, outBank, options, e4bFile);
+				}
+
+				// Fall back to regular stream reading if the file cannot be mapped.
+			}
+			
+			std::ifstream stream(e4bFile.c_str(), std::ios::binary);
+			if (stream.is_open())
+			{
+				return read_helpers::ReadE4BStream(stream, outBank, options, e4bFile);
+			}
+		}
+		
+		return EE4BReadResult::FILE_NOT_EXIST;
+	}
+
+	/**
+	 * \brief Reads a bank from memory, e.g. a loaded .E4B file.
+	 * \param owner Optionally keeps the memory alive, in which case sample data is viewed in place instead of copied
+	 */
+	inline EE4BReadResult ReadE4B(const Span<const char> e4bData, E4BBank& outBank, const E4BReadOptions& options = E4BReadOptions(),
+		std::shared_ptr<const void> owner = nullptr)
+	{
+		assert(!e4bData.empty());
+		if(e4bData.empty()) { return EE4BReadResult::FILE_INVALID; }
+
+		// There is no file to map or to defer reading from:
+		E4BReadOptions memoryOptions(options);
+		memoryOptions.m_memoryMapped = false;
+		memoryOptions.m_deferSampleData = false;
+		
+		if(memoryOptions.m_numThreads != 1u)
+		{
+			return read_helpers::ReadE4BParallel(e4bData, owner, outBank, memoryOptions, std::filesystem::path());
+		}
+		
+		MemoryStream stream(e4bData, std::move(owner));
+		return read_helpers::ReadE4BStream(stream, outBank, memoryOptions, std::filesystem::path());
+	}
+
+	/*
+	 * Index:
+	 */
+
+	struct E4BIndexEntry final
+	{
+		E4BIndexEntry() = default;
+		
+		std::array<char, FORM_CHUNK_MAX_NAME_LEN> m_chunkName{};
+		uint32_t m_chunkSize = 0u; // Size of the chunk data, excluding the chunk header
+		uint32_t m_chunkOffset = 0u; // Absolute offset of the chunk within the file
+		uint16_t m_index = 0ui16;
+		std::string m_name;
+
+		// Only read for presets when requested, as these require touching the E4P1 chunk itself:
+		uint16_t m_numVoices = 0ui16;
+		int8_t m_transpose = 0i8;
+		int8_t m_volume = 0i8;
+
+		[[nodiscard]] std::string_view GetChunkName() const { return {m_chunkName.data(), m_chunkName.size()}; }
+	};
+
+	/**
+	 * \brief Lightweight listing of a bank's contents built from the TOC1 chunk alone, without decoding presets or loading sample data.
+	 */
+	struct E4BIndex final
+	{
+		E4BIndex() = default;
+		
+		std::vector<E4BIndexEntry> m_presets{};
+		std::vector<E4BIndexEntry> m_samples{};
+		std::vector<E4BIndexEntry> m_sequences{};
+	};
+
+	/**
+	 * \brief Reads only the FORM and TOC1 chunks of a bank, and optionally the E4P1 preset headers.
+	 */
+	inline EE4BReadResult ReadE4BIndex(const std::filesystem::path& e4bFile, E4BIndex& outIndex, const bool readPresetHeaders = false)
+	{
+		const bool isEOSFileFormat(e4bFile.extension() == ".e4b" || e4bFile.extension() == ".E4B");
+		assert(isEOSFileFormat);
+		if(!isEOSFileFormat) { return EE4BReadResult::FILE_INVALID; }
+
+		if (!std::filesystem::exists(e4bFile)) { return EE4BReadResult::FILE_NOT_EXIST; }
+		
+		std::ifstream stream(e4bFile.c_str(), std::ios::binary);
+		if (!stream.is_open()) { return EE4BReadResult::FILE_NOT_EXIST; }
+
+		FORMChunk form;
+		form.Read(stream);
+
+		std::array<char, 4> E4B0{};
+		stream.read(E4B0.data(), static_cast<std::streamsize>(E4B0.size()));
+
+		if (form.GetName() != "FORM" || std::string_view{E4B0.data(), E4B0.size()} != "E4B0") { return EE4BReadResult::FILE_INVALID; }
+		
+		FORMChunk TOC;
+		TOC.Read(stream);
+
+		const uint32_t numSubchunks(TOC.GetReadSize() / EOS_E4_TOC_SIZE);
+		assert(numSubchunks > 0u);
+		if (TOC.GetName() != "TOC1" || numSubchunks == 0u) { return EE4BReadResult::FILE_INVALID; }
+
+		// Pull the whole table of contents in with a single read:
+		std::vector<char> TOCData(static_cast<size_t>(numSubchunks) * EOS_E4_TOC_SIZE);
+		stream.read(TOCData.data(), static_cast<std::streamsize>(TOCData.size()));
+		if (stream.gcount() != static_cast<std::streamsize>(TOCData.size())) { return EE4BReadResult::FILE_INVALID; }
+
+		MemoryStream TOCStream(TOCData.data(), TOCData.size());
+		for(uint32_t i(0u); i < numSubchunks; ++i)
+		{
+			FORMChunk subChunk;
+			subChunk.Read(TOCStream);
 
-				AddTOCIndex(E3S1, sample->GetIndex(), sample->GetName());
+			E4BIndexEntry entry;
+			std::copy_n(subChunk.GetName().data(), FORM_CHUNK_MAX_NAME_LEN, entry.m_chunkName.data());
+			entry.m_chunkSize = subChunk.GetReadSize() + 2u;
+			
+			TOCStream.read(reinterpret_cast<char*>(&entry.m_chunkOffset), sizeof(uint32_t));
+			entry.m_chunkOffset = byteswap_helpers::byteswap_uint32(entry.m_chunkOffset);
+
+			TOCStream.read(reinterpret_cast<char*>(&entry.m_index), sizeof(uint16_t));
+			entry.m_index = byteswap_helpers::byteswap_uint16(entry.m_index);
+
+			entry.m_name.resize(EOS_E4_MAX_NAME_LEN);
+			TOCStream.read(entry.m_name.data(), EOS_E4_MAX_NAME_LEN);
+
+			TOCStream.ignore(2);
+			
+			if (subChunk.GetName() == "E4P1")
+			{
+				if(readPresetHeaders)
+				{
+					// Index (2), name (16), data size (2), voice count (2), unknown (4), transpose (1), volume (1)
+					std::array<char, 28> presetHeader{};
+					stream.seekg(entry.m_chunkOffset + static_cast<uint32_t>(FORM_CHUNK_MAX_NAME_LEN + sizeof(uint32_t)));
+					stream.read(presetHeader.data(), static_cast<std::streamsize>(presetHeader.size()));
+					if (stream.gcount() != static_cast<std::streamsize>(presetHeader.size())) { return EE4BReadResult::FILE_INVALID; }
+
+					MemoryStream headerStream(presetHeader.data(), presetHeader.size());
+					headerStream.ignore(20);
+					
+					headerStream.read(reinterpret_cast<char*>(&entry.m_numVoices), sizeof(uint16_t));
+					entry.m_numVoices = byteswap_helpers::byteswap_uint16(entry.m_numVoices);
+
+					headerStream.ignore(4);
+
+					headerStream.read(reinterpret_cast<char*>(&entry.m_transpose), sizeof(int8_t));
+					headerStream.read(reinterpret_cast<char*>(&entry.m_volume), sizeof(int8_t));
+				}
 				
-				FORM.m_subChunks.emplace_back(std::move(E3S1));
+				outIndex.m_presets.emplace_back(std::move(entry));
+			}
+			else if (subChunk.GetName() == "E3S1")
+			{
+				outIndex.m_samples.emplace_back(std::move(entry));
+			}
+			else if (subChunk.GetName() == "E4s1")
+			{
+				outIndex.m_sequences.emplace_back(std::move(entry));
+			}
+		}
+
+		return EE4BReadResult::READ_SUCCESS;
+	}
+
+	/*
+	 * Visitor:
+	 */
+
+	/**
+	 * \brief Callbacks for VisitE4B, derive from this and hide the callbacks of interest.
+	 * Everything passed is a view into the bank data that is only valid for the duration of the call.
+	 */
+	struct E4BVisitor
+	{
+		void OnPreset(const E4PresetHeader& /*preset*/) {}
+		
+		// The voice is passed without its zones, which are passed to OnZone afterwards.
+		void OnVoice(const E4PresetHeader& /*preset*/, uint16_t /*voiceIndex*/, const E4Voice& /*voice*/) {}
+		void OnZone(const E4PresetHeader& /*preset*/, uint16_t /*voiceIndex*/, uint8_t /*zoneIndex*/, const E4SampleZone& /*zone*/) {}
+		
+		void OnSampleHeader(const E3SampleHeader& /*sample*/) {}
+		
+		// Called repeatedly with consecutive parts of the sample data, offset being the position of data within all of the sample data.
+		void OnSampleData(const E3SampleHeader& /*sample*/, Span<const int16_t> /*data*/, size_t /*offset*/) {}
+		
+		void OnSequence(uint16_t /*index*/, std::string_view /*name*/, Span<const char> /*midiData*/) {}
+		void OnStartup(std::string_view /*name*/, uint16_t /*currentPreset*/) {}
+	};
+
+	namespace read_helpers
+	{
+		// Number of int16_t passed to each OnSampleData call.
+		constexpr size_t VISIT_SAMPLE_DATA_CHUNK_SIZE = 8192;
+
+		template<typename Visitor>
+		void VisitSampleData(MemoryStream& stream, const E3SampleHeader& sample, Visitor& visitor)
+		{
+			const size_t numSampleData(std::min(sample.m_numSampleData, stream.GetRemaining() / sizeof(int16_t)));
+			const char* data(stream.GetCurrent());
+			
+			if(reinterpret_cast<uintptr_t>(data) % alignof(int16_t) == 0u)
+			{
+				const Span<const int16_t> sampleData(reinterpret_cast<const int16_t*>(data), numSampleData);
+				for(size_t offset(0); offset < numSampleData; offset += VISIT_SAMPLE_DATA_CHUNK_SIZE)
+				{
+					visitor.OnSampleData(sample, sampleData.subspan(offset, std::min(VISIT_SAMPLE_DATA_CHUNK_SIZE, numSampleData - offset)), offset);
+				}
+
+				stream.ignore(static_cast<std::streamsize>(sizeof(int16_t) * numSampleData));
 			}
+			else
+			{
+				// Misaligned data is passed through a bounce buffer instead:
+				std::array<int16_t, VISIT_SAMPLE_DATA_CHUNK_SIZE> chunk;
+				for(size_t offset(0); offset < numSampleData; offset += VISIT_SAMPLE_DATA_CHUNK_SIZE)
+				{
+					const size_t chunkSize(std::min(VISIT_SAMPLE_DATA_CHUNK_SIZE, numSampleData - offset));
+					stream.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(sizeof(int16_t) * chunkSize));
+					
+					visitor.OnSampleData(sample, Span<const int16_t>(chunk.data(), chunkSize), offset);
+				}
+			}
+		}
+	}
 
-			FORMChunk EMSt("EMSt");
+	/**
+	 * \brief Walks a bank in TOC order, passing everything in it to the visitor rather than building an E4BBank.
+	 * Nothing is allocated per preset, voice, zone, sample or sequence.
+	 */
+	template<typename Visitor>
+	EE4BReadResult VisitE4B(const Span<const char> e4bData, Visitor& visitor)
+	{
+		MemoryStream stream(e4bData);
 			
-			E4EMSt startup("Untitled MSetup ", inBank.GetStartupPreset());
-			startup.Write(EMSt);
+		FORMChunk form;
+		form.Read(stream);
+
+		std::array<char, 4> E4B0{};
+		stream.read(E4B0.data(), static_cast<std::streamsize>(E4B0.size()));
+
+		if (form.GetName() != "FORM" || std::string_view{E4B0.data(), E4B0.size()} != "E4B0") { return EE4BReadResult::FILE_INVALID; }
+
+		FORMChunk TOC;
+		TOC.Read(stream);
+
+		const uint32_t numSubchunks(TOC.GetReadSize() / EOS_E4_TOC_SIZE);
+		assert(numSubchunks > 0u);
+		if (TOC.GetName() != "TOC1" || numSubchunks == 0u) { return EE4BReadResult::FILE_INVALID; }
+
+		MemoryStream chunkStream(e4bData);
+		uint32_t nextChunkPos(0u);
+		
+		for(uint32_t i(0u); i < numSubchunks; ++i)
+		{
+			FORMChunk subChunk;
+			subChunk.Read(stream);
 			
-			FORM.m_subChunks.emplace_back(std::move(EMSt));
+			uint32_t subchunkPos(0u);
+			stream.read(reinterpret_cast<char*>(&subchunkPos), sizeof(uint32_t));
+			subchunkPos = byteswap_helpers::byteswap_uint32(subchunkPos);
+
+			stream.ignore(EOS_E4_TOC_SIZE - FORM_CHUNK_MAX_NAME_LEN - sizeof(uint32_t) * 2u);
+
+			const uint32_t dataPos(subchunkPos + static_cast<uint32_t>(FORM_CHUNK_MAX_NAME_LEN + sizeof(uint32_t)));
+			const uint32_t dataSize(subChunk.GetReadSize() + 2u);
+			nextChunkPos = dataPos + dataSize;
 			
-			FORM.Write(stream);
+			if(dataPos > e4bData.size() || dataSize > e4bData.size() - dataPos) { return EE4BReadResult::FILE_INVALID; }
+			
+			chunkStream.seekg(dataPos);
+
+			if (subChunk.GetName() == "E4P1")
+			{
+				E4PresetHeader preset;
+				if(!preset.Read(chunkStream)) { return EE4BReadResult::FILE_INVALID; }
+
+				visitor.OnPreset(preset);
+
+				for(uint16_t voiceIndex(0ui16); voiceIndex < preset.m_numVoices; ++voiceIndex)
+				{
+					E4Voice voice;
+					const uint8_t zoneCount(voice.ReadWithoutZones(chunkStream));
+					if(zoneCount == 0ui8) { return EE4BReadResult::FILE_INVALID; }
+
+					visitor.OnVoice(preset, voiceIndex, voice);
+
+					for(uint8_t zoneIndex(0ui8); zoneIndex < zoneCount; ++zoneIndex)
+					{
+						E4SampleZone zone;
+						zone.Read(chunkStream);
+
+						visitor.OnZone(preset, voiceIndex, zoneIndex, zone);
+					}
+				}
+			}
+			else if (subChunk.GetName() == "E3S1")
+			{
+				E3SampleHeader sample;
+				sample.Read(chunkStream, dataSize);
+
+				visitor.OnSampleHeader(sample);
+				read_helpers::VisitSampleData(chunkStream, sample, visitor);
+			}
+			else if (subChunk.GetName() == "E4s1")
+			{
+				uint16_t index(0ui16);
+				chunkStream.read(reinterpret_cast<char*>(&index), sizeof(uint16_t));
+				index = byteswap_helpers::byteswap_uint16(index);
+
+				const std::string_view name(chunkStream.GetCurrent(), std::min(EOS_E4_MAX_NAME_LEN, chunkStream.GetRemaining()));
+				chunkStream.ignore(EOS_E4_MAX_NAME_LEN);
+
+				constexpr size_t SEQ_INFO_WITHOUT_SIZE(sizeof(uint16_t) + EOS_E4_MAX_NAME_LEN);
+				visitor.OnSequence(index, name, Span<const char>(chunkStream.GetCurrent(), dataSize > SEQ_INFO_WITHOUT_SIZE ? dataSize - SEQ_INFO_WITHOUT_SIZE : 0));
+			}
+			else if (subChunk.GetName() != "E4Ma" && subChunk.GetName() != "EMS0")
+			{
+				return EE4BReadResult::FILE_INVALID;
+			}
+		}
+
+		// The startup chunk follows the last chunk listed in TOC1:
+		chunkStream.seekg(nextChunkPos);
+		
+		FORMChunk startupChunk;
+		startupChunk.Read(chunkStream);
+
+		if (!chunkStream.eof() && startupChunk.GetName() == "EMSt" && chunkStream.GetRemaining() >= sizeof(uint16_t) * 2u + EOS_E4_MAX_NAME_LEN + 4u)
+		{
+			chunkStream.ignore(2);
+
+			const std::string_view name(chunkStream.GetCurrent(), EOS_E4_MAX_NAME_LEN);
+			chunkStream.ignore(EOS_E4_MAX_NAME_LEN + 4u);
+
+			uint16_t currentPreset(0ui16);
+			chunkStream.read(reinterpret_cast<char*>(&currentPreset), sizeof(uint16_t));
+			
+			visitor.OnStartup(name, byteswap_helpers::byteswap_uint16(currentPreset));
+		}
+
+		return EE4BReadResult::READ_SUCCESS;
+	}
+
+	/**
+	 * \brief Maps the file and walks it with VisitE4B.
+	 */
+	template<typename Visitor>
+	EE4BReadResult VisitE4B(const std::filesystem::path& e4bFile, Visitor& visitor)
+	{
+		const bool isEOSFileFormat(e4bFile.extension() == ".e4b" || e4bFile.extension() == ".E4B");
+		assert(isEOSFileFormat);
+		if(!isEOSFileFormat) { return EE4BReadResult::FILE_INVALID; }
+
+		if (!std::filesystem::exists(e4bFile)) { return EE4BReadResult::FILE_NOT_EXIST; }
+
+		const MappedFile mappedFile(e4bFile);
+		if (!mappedFile.IsOpen()) { return EE4BReadResult::FILE_INVALID; }
+
+		return VisitE4B(Span<const char>(mappedFile.GetData(), mappedFile.GetSize()), visitor);
+	}
+
+	/**
+	 * \brief Reads only the presets of a bank, each kept as it was encoded. Samples and sequences are skipped.
+	 */
+	inline EE4BReadResult ReadE4BCompactPresets(const Span<const char> e4bData, std::vector<E4CompactPreset>& outPresets)
+	{
+		MemoryStream stream(e4bData);
+			
+		FORMChunk form;
+		form.Read(stream);
+
+		std::array<char, 4> E4B0{};
+		stream.read(E4B0.data(), static_cast<std::streamsize>(E4B0.size()));
+
+		if (form.GetName() != "FORM" || std::string_view{E4B0.data(), E4B0.size()} != "E4B0") { return EE4BReadResult::FILE_INVALID; }
+
+		FORMChunk TOC;
+		TOC.Read(stream);
+
+		const uint32_t numSubchunks(TOC.GetReadSize() / EOS_E4_TOC_SIZE);
+		if (TOC.GetName() != "TOC1" || numSubchunks == 0u || numSubchunks > stream.GetRemaining() / EOS_E4_TOC_SIZE) { return EE4BReadResult::FILE_INVALID; }
+
+		std::vector<E4CompactPreset> presets;
+		for(uint32_t i(0u); i < numSubchunks; ++i)
+		{
+			FORMChunk subChunk;
+			subChunk.Read(stream);
+			
+			uint32_t subchunkPos(0u);
+			stream.read(reinterpret_cast<char*>(&subchunkPos), sizeof(uint32_t));
+			subchunkPos = byteswap_helpers::byteswap_uint32(subchunkPos);
+
+			stream.ignore(EOS_E4_TOC_SIZE - FORM_CHUNK_MAX_NAME_LEN - sizeof(uint32_t) * 2u);
+
+			if (subChunk.GetName() != "E4P1") { continue; }
+
+			const uint32_t dataPos(subchunkPos + static_cast<uint32_t>(FORM_CHUNK_MAX_NAME_LEN + sizeof(uint32_t)));
+			const uint32_t dataSize(subChunk.GetReadSize() + 2u);
+			if(dataPos > e4bData.size() || dataSize > e4bData.size() - dataPos) { return EE4BReadResult::FILE_INVALID; }
+
+			// Limited to the chunk, so a corrupt voice can't read into whatever follows it:
+			MemoryStream chunkStream(e4bData.subspan(dataPos, dataSize));
+
+			E4CompactPreset preset;
+			if(!preset.Read(chunkStream)) { return EE4BReadResult::FILE_INVALID; }
+
+			presets.emplace_back(std::move(preset));
+		}
+
+		outPresets = std::move(presets);
+		return EE4BReadResult::READ_SUCCESS;
+	}
+
+	/**
+	 * \brief Maps the file and reads its presets with ReadE4BCompactPresets.
+	 */
+	inline EE4BReadResult ReadE4BCompactPresets(const std::filesystem::path& e4bFile, std::vector<E4CompactPreset>& outPresets)
+	{
+		const bool isEOSFileFormat(e4bFile.extension() == ".e4b" || e4bFile.extension() == ".E4B");
+		assert(isEOSFileFormat);
+		if(!isEOSFileFormat) { return EE4BReadResult::FILE_INVALID; }
+
+		if (!std::filesystem::exists(e4bFile)) { return EE4BReadResult::FILE_NOT_EXIST; }
+
+		const MappedFile mappedFile(e4bFile);
+		if (!mappedFile.IsOpen()) { return EE4BReadResult::FILE_INVALID; }
+
+		return ReadE4BCompactPresets(Span<const char>(mappedFile.GetData(), mappedFile.GetSize()), outPresets);
+	}
+
+	/**
+	 * \brief Writes the bank, replacing e4bFile only once the whole bank is written. e4bFile may be the file the bank was read from.
+	 * It may also be the file the bank was mapped from (E4BReadOptions::m_memoryMapped), except on Windows, where it can't be replaced while mapped.
+	 * Each of compactPresets is written exactly as it was read, in place of any preset in the bank with the same index.
+	 * The bank's sample uses don't account for compactPresets, so samples they play must stay in the bank.
+	 * \return false if e4bFile isn't an .E4B file or couldn't be written, e4bFile is then left as it was
+	 */
+	inline bool WriteE4B(const std::filesystem::path& e4bFile, const E4BBank& inBank, const Span<const E4CompactPreset> compactPresets)
+	{
+		const bool isEOSFileFormat(e4bFile.extension() == ".e4b" || e4bFile.extension() == ".E4B");
+		assert(isEOSFileFormat);
+		if(!isEOSFileFormat) { return false; }
+		
+		struct TOCChunk final
+		{
+			FORMChunk m_chunk;
+			uint16_t m_index = 0ui16;
+			std::string_view m_name;
+
+			// Written straight from where it lives after m_chunk, instead of being copied into it:
+			Span<const char> m_payload{};
+		};
+		
+		// Encode every chunk listed in the TOC up front, so that each size is only computed once below:
+		std::vector<TOCChunk> chunks;
+		chunks.reserve(inBank.GetPresets().size() + compactPresets.size() + inBank.GetSamples().size());
+		
+		for(const auto& preset : inBank.GetPresets())
+		{
+			const bool isReplaced(std::any_of(compactPresets.begin(), compactPresets.end(), [&](const E4CompactPreset& compactPreset) { return compactPreset.GetIndex() == preset->GetIndex(); }));
+			if(isReplaced) { continue; }
+			
+			FORMChunk E4P1("E4P1");
+			preset->Write(E4P1);
+
+			chunks.push_back({std::move(E4P1), preset->GetIndex(), preset->GetName()});
+		}
+
+		for(const auto& preset : compactPresets)
+		{
+			FORMChunk E4P1("E4P1");
+			preset.Write(E4P1);
+
+			chunks.push_back({std::move(E4P1), preset.GetIndex(), preset.GetName()});
+		}
+
+		// Presets are listed in index order, wherever they came from:
+		std::stable_sort(chunks.begin(), chunks.end(), [](const TOCChunk& lhs, const TOCChunk& rhs) { return lhs.m_index < rhs.m_index; });
+		
+		for(const auto& sample : inBank.GetSamples())
+		{
+			const Span<const int16_t> sampleData(sample->GetRawSampleData());
+			if(sampleData.empty())
+			{
+				assert(!sampleData.empty());
+				continue;
+			}
+
+			const Span<const char> payload(reinterpret_cast<const char*>(sampleData.data()), sizeof(int16_t) * sampleData.size());
+			
+			FORMChunk E3S1("E3S1", static_cast<uint32_t>(E3SampleHeader::SIZE + payload.size()));
+			sample->WriteHeader(E3S1);
+
+			chunks.push_back({std::move(E3S1), sample->GetIndex(), sample->GetName(), payload});
 		}
+
+		FORMChunk EMSt("EMSt");
+		
+		E4EMSt startup("Untitled MSetup ", inBank.GetStartupPreset());
+		startup.Write(EMSt);
+
+		// Lay out the file in a single pass: the FORM header, E4B0 and the TOC, followed by every chunk in TOC order and then EMSt.
+		constexpr uint32_t CHUNK_HEADER_SIZE(static_cast<uint32_t>(FORM_CHUNK_MAX_NAME_LEN + sizeof(uint32_t)));
+		constexpr std::string_view E4B0("E4B0");
+		
+		const uint32_t TOCSize(CHUNK_HEADER_SIZE + EOS_E4_TOC_SIZE * static_cast<uint32_t>(chunks.size()));
+		uint32_t chunkLoc(CHUNK_HEADER_SIZE + static_cast<uint32_t>(E4B0.length()) + TOCSize);
+		
+		FORMChunk TOC("TOC1");
+		TOC.m_subChunks.reserve(chunks.size());
+		
+		for(const auto& chunk : chunks)
+		{
+			const uint32_t chunkSize(chunk.m_chunk.GetFullSize(false) + static_cast<uint32_t>(chunk.m_payload.size()));
+			
+			FORMChunk TOCSubchunk(std::string(chunk.m_chunk.GetName()), chunkSize - 2u);
+
+			const uint32_t TOCChunkLoc(byteswap_helpers::byteswap_uint32(chunkLoc));
+			TOCSubchunk.writeType(&TOCChunkLoc, sizeof(uint32_t));
+
+			const uint16_t index(byteswap_helpers::byteswap_uint16(chunk.m_index));
+			TOCSubchunk.writeType(&index, sizeof(uint16_t));
+
+			TOCSubchunk.writeType(chunk.m_name.data(), chunk.m_name.length());
+
+			const char* null(nullptr);
+			TOCSubchunk.writeType(null, sizeof(uint16_t));
+
+			TOC.m_subChunks.emplace_back(std::move(TOCSubchunk));
+			
+			chunkLoc += CHUNK_HEADER_SIZE + chunkSize;
+		}
+
+		// chunkLoc is now where EMSt starts:
+		FORMChunk FORM("FORM", chunkLoc + EMSt.GetFullSize(true) - CHUNK_HEADER_SIZE);
+		FORM.writeType(E4B0.data(), E4B0.length());
+
+		// Headers are gathered into one buffer while sample data is handed over in place, so the file is written with a few vectored writes:
+		GatherFileWriter writer;
+		FORM.Write(writer);
+		TOC.Write(writer);
+
+		for(const auto& chunk : chunks)
+		{
+			chunk.m_chunk.Write(writer);
+			writer.WriteInPlace(chunk.m_payload);
+		}
+		
+		EMSt.Write(writer);
+
+		return writer.Flush(e4bFile);
+	}
+
+	/**
+	 * \brief Writes the bank, replacing e4bFile only once the whole bank is written. e4bFile may be the file the bank was read from.
+	 * It may also be the file the bank was mapped from (E4BReadOptions::m_memoryMapped), except on Windows, where it can't be replaced while mapped.
+	 * \return false if e4bFile isn't an .E4B file or couldn't be written, e4bFile is then left as it was
+	 */
+	inline bool WriteE4B(const std::filesystem::path& e4bFile, const E4BBank& inBank)
+	{
+		return WriteE4B(e4bFile, inBank, Span<const E4CompactPreset>());
 	}
 }
\ No newline at end of file